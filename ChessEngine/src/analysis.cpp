@@ -0,0 +1,152 @@
+#include "analysis.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+
+#include "core/engine.hpp"
+#include "core/gameState.hpp"
+#include "core/movegen.hpp"
+#include "bot/bot.hpp"
+#include "notation.hpp"
+
+using namespace std::chrono;
+
+static std::string Escape(const std::string& s, bool json)
+{
+    std::string out;
+    for (char c : s)
+    {
+        if (c == '"') out += json ? "\\\"" : "\"\"";
+        else if (c == '\\' && json) out += "\\\\";
+        else out += c;
+    }
+    return out;
+}
+
+bool RunAnalysis(const std::string& epdPath, std::ostream& out, const AnalysisOptions& options, AnalysisStats* statsOut)
+{
+    std::ifstream in(epdPath);
+    if (!in)
+    {
+        std::cerr << "Can't open " << epdPath << '\n';
+        return false;
+    }
+
+    auto start = steady_clock::now();
+
+    SearchLimits limits;
+    limits.depth = options.depth;
+    limits.moveTime = options.moveTime;
+    limits.nodes = options.nodes;
+    limits.moveOverhead = 0;
+    limits.useBook = false;
+    if (limits.depth <= 0 && limits.moveTime <= 0 && limits.nodes <= 0)
+        limits.depth = 8;
+
+    const bool json = options.json;
+    if (!json)
+        out << "index,id,fen,bestmove,score,nodes,time_ms\n";
+
+    std::mutex inMutex, outMutex;
+    uint64_t nextIndex = 0;
+    AnalysisStats stats;
+
+    auto worker = [&]()
+    {
+        // Own position and search per thread, GameState is thread local
+        GameState::Reset();
+        Engine engine;
+        Bot bot(&engine, Color::WHITE, options.hashMB);
+        bot.SetSilent(true);
+
+        std::string line, fen, id;
+        while (true)
+        {
+            uint64_t index;
+            {
+                // Lines are pulled one at a time so huge files are never fully in memory
+                std::lock_guard<std::mutex> lock(inMutex);
+                if (!std::getline(in, line)) break;
+                index = nextIndex++;
+            }
+
+            if (line.find_first_not_of(" \t\r") == std::string::npos || line[0] == '#')
+                continue;
+
+            if (!ParseEPDLine(line, fen, id))
+            {
+                std::lock_guard<std::mutex> lock(outMutex);
+                ++stats.failed;
+                std::cerr << "Skipping line " << index + 1 << ": not a position\n";
+                continue;
+            }
+
+            GameState::Reset();
+            engine.Init(fen);
+
+            auto searchStart = steady_clock::now();
+            std::string bestMove = "none";
+            std::string score;
+            uint64_t nodes = 0;
+
+            // Mate/stalemate positions have nothing to search
+            Color us = engine.GetCurrentPlayer();
+            bool inCheck = engine.InCheck(us); // Before movegen, making/unmaking moves doesn't restore it
+            if (Movegen::GetAllLegalMoves(us, engine.GetBitboardBoard(), &engine).empty())
+                score = inCheck ? "mate 0" : "cp 0";
+            else
+            {
+                try
+                {
+                    bot.SetColor(us);
+                    Move move = bot.GetMoveUCI(limits);
+                    bestMove = MoveToUCI(move);
+                    score = ScoreToUCI(bot.GetLastScore());
+                    nodes = bot.GetNodesSearched();
+                }
+                catch (const char* error)
+                {
+                    std::lock_guard<std::mutex> lock(outMutex);
+                    ++stats.failed;
+                    std::cerr << "Search failed on line " << index + 1 << ": " << error << '\n';
+                    continue;
+                }
+            }
+            long long ms = duration_cast<milliseconds>(steady_clock::now() - searchStart).count();
+
+            std::ostringstream result;
+            if (json)
+                result << "{\"index\":" << index << ",\"id\":\"" << Escape(id, true) << "\",\"fen\":\"" << fen
+                       << "\",\"bestmove\":\"" << bestMove << "\",\"score\":\"" << score
+                       << "\",\"nodes\":" << nodes << ",\"time_ms\":" << ms << "}\n";
+            else
+                result << index << ",\"" << Escape(id, false) << "\"," << fen << ',' << bestMove << ','
+                       << score << ',' << nodes << ',' << ms << '\n';
+
+            std::lock_guard<std::mutex> lock(outMutex);
+            out << result.str();
+            out.flush();
+            ++stats.positions;
+            stats.nodes += nodes;
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t < std::max(1, options.threads); ++t)
+        pool.emplace_back(worker);
+    for (std::thread& t : pool)
+        t.join();
+
+    stats.timeMs = duration_cast<milliseconds>(steady_clock::now() - start).count();
+    std::cerr << "Positions: " << stats.positions << "  skipped: " << stats.failed << "  nodes: " << stats.nodes
+              << "  time (ms): " << stats.timeMs << "  nps: " << (stats.nodes * 1000 / (stats.timeMs + 1)) << '\n';
+
+    if (statsOut) *statsOut = stats;
+    return true;
+}
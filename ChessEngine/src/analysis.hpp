@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <ostream>
+
+struct AnalysisOptions
+{
+    int threads = 1;
+    int depth = -1;         // Fixed depth per position
+    int moveTime = -1;      // Fixed time per position in ms
+    long long nodes = -1;   // Node budget per position
+    int hashMB = 16;        // Per thread, every worker has its own Bot
+    bool json = false;      // JSON lines instead of CSV
+};
+
+struct AnalysisStats
+{
+    uint64_t positions = 0;
+    uint64_t failed = 0;    // Lines that weren't a position
+    uint64_t nodes = 0;
+    long long timeMs = 0;
+};
+
+// Searches every position of an EPD (or FEN per line) file on a pool of worker threads, each with its own Engine and Bot
+// One result (index, id, fen, best move, score, nodes, time) is written to out as soon as it's done, so the order
+// follows completion, index is the line's position in the file. Depth 8 if no limit is given
+// Returns false if the file couldn't be opened
+bool RunAnalysis(const std::string& epdPath, std::ostream& out, const AnalysisOptions& options, AnalysisStats* stats = nullptr);
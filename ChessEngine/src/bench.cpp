@@ -0,0 +1,140 @@
+#include "bench.hpp"
+
+#include <iostream>
+#include <chrono>
+#include <string>
+#include <algorithm>
+
+#include "core/gameState.hpp"
+#include "core/cpu.hpp"
+#include "core/movegen.hpp"
+#include "core/eval.hpp"
+
+// Mix of openings, middlegames and endgames. Every position has more than 7 pieces so
+// tablebases never short circuit the search, and none have an en passant square
+static const char* benchPositions[] = {
+    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+    "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 10",
+    "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 11",
+    "4rrk1/pp1n3p/3q2pQ/2p1pb2/2PP4/2P3N1/P2B2PP/4RRK1 b - - 7 19",
+    "rq3rk1/ppp2ppp/1bnpb3/3N2B1/3NP3/7P/PPPQ1PP1/2KR3R w - - 7 14",
+    "r1bq1r1k/1pp1n1pp/1p1p4/4p2Q/4Pp2/1BNP4/PPP2PPP/3R1RK1 w - - 2 14",
+    "r3r1k1/2p2ppp/p1p1bn2/8/1q2P3/2NPQN2/PPP3PP/R4RK1 b - - 2 15",
+    "r1bbk1nr/pp3p1p/2n5/1N4p1/2Np1B2/8/PPP2PPP/2KR1B1R w kq - 0 13",
+    "r1bq1rk1/ppp1nppp/4n3/3p3Q/3P4/1BP1B3/PP1N2PP/R4RK1 w - - 1 16",
+    "4r1k1/r1q2ppp/ppp2n2/4P3/5Rb1/1N1BQ3/PPP3PP/R5K1 w - - 1 17",
+    "2rqkb1r/ppp2p2/2npb1p1/1N1Nn2p/2P1PP2/8/PP2B1PP/R1BQK2R b KQ - 0 11",
+    "r1bq1r1k/b1p1npp1/p2p3p/1p6/3PP3/1B2NN2/PP3PPP/R2Q1RK1 w - - 1 16",
+    "3r1rk1/p5pp/bpp1pp2/8/q1PP1P2/b3P3/P2NQRPP/1R2B1K1 b - - 6 22",
+    "r1q2rk1/2p1bppp/2Pp4/p6b/Q1PNp3/4B3/PP1R1PPP/2K4R w - - 2 18",
+    "4k2r/1pb2ppp/1p2p3/1R1p4/3P4/2r1PN2/P4PPP/1R4K1 b - - 3 22",
+    "3q2k1/pb3p1p/4pbp1/2r5/PpN2N2/1P2P2P/5PP1/Q2R2K1 b - - 4 26",
+    "6k1/6p1/6Pp/ppp5/3pn2P/1P3K2/1PP2P2/3N4 b - - 0 1",
+    "3b4/5kp1/1p1p1p1p/pP1PpP1P/P1P1P3/3KN3/8/8 w - - 0 1",
+    "8/6pk/1p6/8/PP3p1p/5P2/4KP1q/3Q4 w - - 0 1",
+    "7k/3p2pp/4q3/8/4Q3/5Kp1/P6b/8 w - - 0 1",
+    "8/2p5/8/2kPKp1p/2p4P/2P5/3P4/8 w - - 0 1",
+    "8/1p3pp1/7p/5P1P/2k3P1/8/2K2P2/8 w - - 0 1",
+    "8/pp2r1k1/2p1p3/3pP2p/1P1P1P1P/P5KR/8/8 w - - 0 1",
+    "8/3p4/p1bk3p/Pp6/1Kp1PpPp/2P2P1P/2P5/5B2 b - - 0 1",
+    "5k2/7R/4P2p/5K2/p1r2P1p/8/8/8 b - - 0 1",
+    "6k1/6p1/P6p/r1N5/5p2/7P/1b3PP1/4R1K1 w - - 0 1",
+    "1r3k2/4q3/2Pp3b/3Bp3/2Q2p2/1p1P2P1/1P2KP2/3N4 w - - 0 1",
+    "6k1/4pp1p/3p2p1/P1pPb3/R7/1r2P1PP/3B1P2/6K1 w - - 0 1",
+    "8/3p3B/5p2/5P2/p7/PP5b/k7/6K1 b - - 0 1",
+    "4rrk1/1p1nq3/p7/2p1P1pp/3P2bp/3Q1Bn1/PPPB4/1K2R1NR w - - 40 21",
+    "r3k2r/3nnpbp/q2pp1p1/p7/Pp1PPPP1/4BNN1/1P5P/R2Q1RK1 w kq - 0 16",
+    "3Qb1k1/1r2ppb1/pN1n2q1/Pp1Pp1Pr/4P2p/4BP2/4B1R1/1R5K b - - 11 40",
+    "4k3/3q1r2/1N2r1b1/3ppN2/2nPP3/1B1R2n1/2R1Q3/3K4 w - - 5 1",
+    "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+    "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+    "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+    "rnbqkbnr/pp1ppppp/8/2p5/4P3/8/PPPP1PPP/RNBQKBNR w KQkq - 0 2",
+    "rnbqkbnr/ppp2ppp/4p3/3p4/3PP3/8/PPP2PPP/RNBQKBNR w KQkq - 0 3",
+    "r1bqkbnr/pppp1ppp/2n5/1B2p3/4P3/5N2/PPPP1PPP/RNBQK2R b KQkq - 3 3",
+    "rnbqkb1r/ppp2ppp/4pn2/3p2B1/2PP4/2N5/PP2PPPP/R2QKBNR b KQkq - 3 4",
+    "rnbq1rk1/ppp1ppbp/3p1np1/8/2PPP3/2N2N2/PP3PPP/R1BQKB1R b KQ - 1 5",
+    "r1bqk1nr/pppp1ppp/2n5/2b1p3/2B1P3/5N2/PPPP1PPP/RNBQK2R w KQkq - 4 4",
+    "rnbqk2r/pppp1ppp/4pn2/8/1bPP4/2N5/PP2PPPP/R1BQKBNR w KQkq - 2 4",
+    "r1b2rk1/2q1bppp/p2p1n2/np2p3/3PP3/2P2N1P/PPB2PP1/RNBQR1K1 w - - 1 12",
+    "2rr3k/pp3pp1/1nnqbN1p/3pN3/2pP4/2P3Q1/PPB4P/R4RK1 w - - 0 1",
+    "1k1r4/pp1b1R2/3q2pp/4p3/2B5/4Q3/PPP2B2/2K5 b - - 0 1",
+    "5rk1/1ppb3p/p1pb4/6q1/3P1p1r/2P1R2P/PP1BQ1P1/5RKN w - - 0 1",
+    "r1bq2rk/pp3pbp/2p1p1pQ/7P/3P4/2PB1N2/PP3PP1/R3K2R w KQ - 0 1",
+    "5k2/6pp/p1qN4/1p1p4/3P4/2PKP2Q/PP3r2/3R4 b - - 0 1",
+    "r5k1/5ppp/8/8/8/8/5PPP/R5K1 w - - 0 1",
+};
+
+BenchResult RunBench(Engine* engine, Bot* bot, int depth)
+{
+    SearchLimits limits;
+    limits.depth = depth;
+
+    const int count = sizeof(benchPositions) / sizeof(benchPositions[0]);
+    BenchResult result = { 0, 0 };
+    uint64_t evalProbes = 0, evalCacheHits = 0, ttEvalHits = 0;
+
+    for (int i = 0; i < count; ++i)
+    {
+        std::cerr << "\nPosition: " << (i + 1) << '/' << count << " (" << benchPositions[i] << ")\n";
+
+        // Every position starts from a clean state so the signature doesn't depend on what ran before
+        GameState::Reset();
+        engine->Init(benchPositions[i]);
+        bot->Clear();
+        bot->SetColor(engine->GetCurrentPlayer());
+
+        auto start = std::chrono::steady_clock::now();
+        bot->GetMoveUCI(limits);
+        result.timeMs += std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+        result.nodes += bot->GetNodesSearched();
+        evalProbes += bot->GetEvalProbes();
+        evalCacheHits += bot->GetEvalCacheHits();
+        ttEvalHits += bot->GetTTEvalHits();
+    }
+
+    std::cerr << "\n===========================\n";
+    std::cerr << "Total time (ms) : " << result.timeMs << '\n';
+    std::cerr << "Nodes searched  : " << result.nodes << '\n';
+    std::cerr << "Nodes/second    : " << (result.nodes * 1000 / (result.timeMs + 1)) << '\n';
+    std::cerr << "Static evals    : " << evalProbes << ", " << (evalCacheHits + ttEvalHits) * 100.0 / std::max<uint64_t>(evalProbes, 1)
+              << "% cached (eval cache " << evalCacheHits * 100.0 / std::max<uint64_t>(evalProbes, 1)
+              << "%, TT " << ttEvalHits * 100.0 / std::max<uint64_t>(evalProbes, 1) << "%)\n";
+    std::cerr << "Build           : " << Cpu::Name(Cpu::Compiled()) << " (cpu supports " << Cpu::Name(Cpu::Best()) << "), " << Movegen::SliderLookupName() << " sliders\n";
+    std::cout << "Bench signature: " << result.nodes << std::endl;
+
+    return result;
+}
+
+// Every timed result is written here so the calls can't be optimized out
+static volatile int evalSink;
+
+double TimeEval(Engine* engine, int runs)
+{
+    Color us = engine->GetCurrentPlayer();
+    auto start = std::chrono::steady_clock::now();
+    for (int r = 0; r < runs; ++r)
+        evalSink = Eval(us, engine);
+    long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+    return (double)ns / runs;
+}
+
+double RunEvalBench(Engine* engine, int runs)
+{
+    const int count = sizeof(benchPositions) / sizeof(benchPositions[0]);
+    double total = 0;
+
+    for (int i = 0; i < count; ++i)
+    {
+        GameState::Reset();
+        engine->Init(benchPositions[i]);
+        total += TimeEval(engine, runs);
+    }
+
+    double perEval = total / count;
+    std::cerr << "Evals           : " << (long long)count * runs << '\n';
+    std::cerr << "Total time (ms) : " << (long long)(total * runs / 1000000) << '\n';
+    std::cerr << "Evals/second    : " << (long long)(1e9 / perEval) << '\n';
+    std::cout << "ns/eval: " << perEval << std::endl;
+    return perEval;
+}
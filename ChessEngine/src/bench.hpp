@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstdint>
+
+#include "core/engine.hpp"
+#include "bot/bot.hpp"
+
+constexpr int BENCH_DEFAULT_DEPTH = 5;
+
+struct BenchResult
+{
+    uint64_t nodes;
+    long long timeMs;
+};
+
+// Runs a fixed depth search over the built in position suite and prints nodes, time and nps
+// The total node count is the bench signature, if it changes the search changed (not just the speed)
+BenchResult RunBench(Engine* engine, Bot* bot, int depth = BENCH_DEFAULT_DEPTH);
+
+// Static eval throughput over the same positions, every one evaluated `runs` times. Prints ns per Eval()
+// Doesn't search, so it's the leaf cost on its own
+double RunEvalBench(Engine* engine, int runs = 200000);
+
+// Average ns of one Eval() for the side to move in the engine's current position, over `runs` calls
+double TimeEval(Engine* engine, int runs);
@@ -0,0 +1,27 @@
+#include "cli.hpp"
+
+#include <iostream>
+
+// Entry point of the standalone bench/perft/analyze/selfplay/book/data/tune executable (CMake target chess_bench), no window or UCI loop
+
+int main(int argc, char* argv[])
+{
+    int exitCode = 0;
+    if (RunToolCommand(argc, argv, exitCode))
+        return exitCode;
+
+    std::cerr << "usage:\n"
+              << "  " << argv[0] << " bench [depth]\n"
+              << "  " << argv[0] << " bench eval [runs]\n"
+              << "  " << argv[0] << " perft suite [maxDepth]\n"
+              << "  " << argv[0] << " perft <depth> [threads N] [split] [fen]\n"
+              << "  " << argv[0] << " analyze <positions.epd> [depth D] [movetime MS] [nodes N] [threads T] [hash MB] [csv|json] [out file]\n"
+              << "  " << argv[0] << " selfplay [games N] [threads T] [depth D|movetime MS|nodes N] [hash MB] [openings file.epd] [bookfile file.bin]\n"
+              << "           [book plies] [random plies] [resignscore CP] [resignmoves N] [drawscore CP] [drawmoves N] [drawply P] [maxplies P]\n"
+              << "           [pgn out.pgn] [data out.bin] [seed S]\n"
+              << "  " << argv[0] << " book <games.pgn> <out.bin> [threads N] [plies P] [min G] [memory MB]\n"
+              << "  " << argv[0] << " epd2bin <labeled.epd> <out.bin>\n"
+              << "  " << argv[0] << " bin2epd <data.bin> <out.epd>\n"
+              << "  " << argv[0] << " tune <data.bin> [threads T] [epochs N] [batch B] [rate R] [k K] [lambda L] [nomaterial] [report N] [out file]\n";
+    return 1;
+}
@@ -0,0 +1,464 @@
+#include "bookBuilder.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cctype>
+#include <memory>
+
+#include "core/movegen.hpp"
+#include "core/gameState.hpp"
+#include "core/boardCalculator.hpp"
+#include "bot/opening.hpp"
+#include "notation.hpp"
+
+using namespace std::chrono;
+
+static const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+// One (position, move) seen in a game, duplicates get summed up
+struct BookRecord
+{
+    uint64_t key;
+    uint32_t score;  // 2 per win, 1 per draw
+    uint16_t games;  // Saturates, only used for minGames
+    uint16_t move;   // Polyglot encoded
+};
+static_assert(sizeof(BookRecord) == 16, "Runs are written as raw records");
+
+static bool RecordLess(const BookRecord& a, const BookRecord& b)
+{
+    return a.key != b.key ? a.key < b.key : a.move < b.move;
+}
+
+static void AddRecord(BookRecord& into, const BookRecord& from)
+{
+    into.score += from.score;
+    into.games = (uint16_t)std::min<uint32_t>(65535u, (uint32_t)into.games + from.games);
+}
+
+// Sorts and folds duplicate (key, move) records together
+static void Combine(std::vector<BookRecord>& records)
+{
+    if (records.empty()) return;
+    std::sort(records.begin(), records.end(), RecordLess);
+
+    size_t out = 0;
+    for (size_t i = 1; i < records.size(); ++i)
+    {
+        if (records[i].key == records[out].key && records[i].move == records[out].move)
+            AddRecord(records[out], records[i]);
+        else
+            records[++out] = records[i];
+    }
+    records.resize(out + 1);
+}
+
+namespace
+{
+    // Bounded hand off from the reader to the parser threads, keeps memory flat on huge files
+    class BatchQueue
+    {
+    public:
+        explicit BatchQueue(size_t maxBatches) : maxBatches(maxBatches) {}
+
+        void Push(std::vector<std::string>&& batch)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            notFull.wait(lock, [&] { return batches.size() < maxBatches; });
+            batches.push_back(std::move(batch));
+            notEmpty.notify_one();
+        }
+
+        // False once the reader is done and everything was taken
+        bool Pop(std::vector<std::string>& batch)
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            notEmpty.wait(lock, [&] { return !batches.empty() || finished; });
+            if (batches.empty()) return false;
+            batch = std::move(batches.front());
+            batches.pop_front();
+            notFull.notify_one();
+            return true;
+        }
+
+        void Finish()
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            finished = true;
+            notEmpty.notify_all();
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable notEmpty, notFull;
+        std::deque<std::vector<std::string>> batches;
+        size_t maxBatches;
+        bool finished = false;
+    };
+
+    // Sorted runs on disk, named <out>.runN.tmp
+    class RunFiles
+    {
+    public:
+        explicit RunFiles(const std::string& base) : base(base) {}
+
+        bool Write(const std::vector<BookRecord>& records)
+        {
+            std::string path;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                path = base + ".run" + std::to_string(paths.size()) + ".tmp";
+                paths.push_back(path);
+            }
+            std::ofstream out(path, std::ios::binary);
+            out.write(reinterpret_cast<const char*>(records.data()), (std::streamsize)(records.size() * sizeof(BookRecord)));
+            return (bool)out;
+        }
+
+        const std::vector<std::string>& Paths() const { return paths; }
+
+        void Remove()
+        {
+            for (const std::string& path : paths)
+                std::remove(path.c_str());
+        }
+
+    private:
+        std::string base;
+        std::mutex mutex;
+        std::vector<std::string> paths;
+    };
+
+    // Buffered reader over one run for the merge
+    class RunReader
+    {
+    public:
+        explicit RunReader(const std::string& path) : file(path, std::ios::binary) { Refill(); }
+
+        bool Done() const { return pos >= buffer.size(); }
+        const BookRecord& Peek() const { return buffer[pos]; }
+
+        void Next()
+        {
+            if (++pos >= buffer.size())
+                Refill();
+        }
+
+    private:
+        void Refill()
+        {
+            buffer.resize(4096);
+            file.read(reinterpret_cast<char*>(buffer.data()), (std::streamsize)(buffer.size() * sizeof(BookRecord)));
+            buffer.resize((size_t)file.gcount() / sizeof(BookRecord));
+            pos = 0;
+        }
+
+        std::ifstream file;
+        std::vector<BookRecord> buffer;
+        size_t pos = 0;
+    };
+
+    // Tags we care about plus the moves, comments/variations/NAGs/move numbers stripped
+    struct ParsedGame
+    {
+        std::string result;
+        std::string fen;
+        std::vector<std::string> moves;
+    };
+
+    void ParseGame(const std::string& text, ParsedGame& game)
+    {
+        game.result.clear();
+        game.fen.clear();
+        game.moves.clear();
+
+        size_t i = 0;
+        const size_t n = text.size();
+        int variationDepth = 0;
+
+        while (i < n)
+        {
+            char c = text[i];
+
+            if (c == '[' && variationDepth == 0)
+            {
+                // [Name "Value"]
+                size_t end = text.find(']', i);
+                if (end == std::string::npos) break;
+                size_t q1 = text.find('"', i);
+                size_t q2 = (q1 < end) ? text.find('"', q1 + 1) : std::string::npos;
+                if (q1 < end && q2 != std::string::npos)
+                {
+                    std::string name = text.substr(i + 1, text.find_first_of(" \t", i + 1) - i - 1);
+                    std::string value = text.substr(q1 + 1, q2 - q1 - 1);
+                    if (name == "Result") game.result = value;
+                    else if (name == "FEN") game.fen = value;
+                    end = text.find(']', q2);
+                    if (end == std::string::npos) break;
+                }
+                i = end + 1;
+            }
+            else if (c == '{')
+            {
+                size_t end = text.find('}', i);
+                i = (end == std::string::npos) ? n : end + 1;
+            }
+            else if (c == ';')
+            {
+                size_t end = text.find('\n', i);
+                i = (end == std::string::npos) ? n : end + 1;
+            }
+            else if (c == '(') { ++variationDepth; ++i; }
+            else if (c == ')') { if (variationDepth > 0) --variationDepth; ++i; }
+            else if (std::isspace((unsigned char)c)) ++i;
+            else
+            {
+                size_t start = i;
+                while (i < n && !std::isspace((unsigned char)text[i]) && text[i] != '{' && text[i] != '(' && text[i] != ')' && text[i] != ';')
+                    ++i;
+                if (variationDepth > 0) continue;
+
+                std::string token = text.substr(start, i - start);
+
+                // "12." / "12..." prefixes, sometimes glued to the move ("12.e4")
+                size_t k = 0;
+                while (k < token.size() && std::isdigit((unsigned char)token[k])) ++k;
+                if (k < token.size() && token[k] == '.')
+                {
+                    while (k < token.size() && token[k] == '.') ++k;
+                    token = token.substr(k);
+                }
+                if (token.empty() || token[0] == '$') continue;
+                if (token == "1-0" || token == "0-1" || token == "1/2-1/2" || token == "*") continue;
+
+                game.moves.push_back(token);
+            }
+        }
+    }
+}
+
+bool BuildBookFromPGN(const std::string& pgnPath, const std::string& binPath, const BookBuildOptions& options, BookBuildStats* statsOut)
+{
+    auto start = steady_clock::now();
+
+    std::ifstream pgn(pgnPath, std::ios::binary);
+    if (!pgn)
+    {
+        std::cerr << "Can't open " << pgnPath << '\n';
+        return false;
+    }
+
+    const int threads = std::max(1, options.threads);
+    const size_t budget = std::max<size_t>(1 << 16, (size_t)std::max(1, options.memoryMB) * 1024 * 1024 / sizeof(BookRecord) / threads);
+
+    BatchQueue queue((size_t)threads * 2);
+    RunFiles runs(binPath);
+    std::atomic<uint64_t> games{ 0 }, skipped{ 0 }, positions{ 0 };
+    std::atomic<bool> writeFailed{ false };
+
+    auto worker = [&]()
+    {
+        // Own position per thread, GameState is thread local
+        GameState::Reset();
+        Engine engine;
+
+        std::vector<BookRecord> records;
+        records.reserve(budget);
+        std::vector<std::string> batch;
+        ParsedGame game;
+
+        auto spill = [&]()
+        {
+            Combine(records);
+            if (!records.empty() && !runs.Write(records))
+                writeFailed = true;
+            records.clear();
+        };
+
+        while (queue.Pop(batch))
+        {
+            for (const std::string& text : batch)
+            {
+                ParseGame(text, game);
+
+                int points[2]; // [white, black]
+                if (game.result == "1-0")          { points[0] = 2; points[1] = 0; }
+                else if (game.result == "0-1")     { points[0] = 0; points[1] = 2; }
+                else if (game.result == "1/2-1/2") { points[0] = 1; points[1] = 1; }
+                else { ++skipped; continue; }
+
+                GameState::Reset();
+                engine.Init(game.fen.empty() ? START_FEN : game.fen);
+
+                bool ok = true;
+                int plies = std::min<int>(options.maxPly, (int)game.moves.size());
+                for (int ply = 0; ply < plies; ++ply)
+                {
+                    Move move = ParseSAN(game.moves[ply], &engine);
+                    if (MoveIsNull(move)) { ok = false; break; }
+
+                    int side = IsWhite(GameState::currentPlayer) ? 0 : 1;
+                    records.push_back({ engine.GetZobristKey(), (uint32_t)points[side], 1, MoveToPolyglot(move) });
+                    engine.MakeMove(move);
+                }
+                ok ? ++games : ++skipped;
+                positions += (uint64_t)plies;
+
+                // Fold duplicates first, only spill if that didn't free up much (openings repeat a lot)
+                if (records.size() >= budget)
+                {
+                    Combine(records);
+                    if (records.size() >= budget / 2)
+                        spill();
+                }
+            }
+        }
+        spill();
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t < threads; ++t)
+        pool.emplace_back(worker);
+
+    // Reader: a new game starts at a tag line that follows movetext
+    {
+        std::vector<std::string> batch;
+        std::string current, line;
+        bool inMoves = false;
+        constexpr size_t BATCH_GAMES = 256;
+
+        auto flushGame = [&]()
+        {
+            if (current.find_first_not_of(" \t\r\n") != std::string::npos)
+                batch.push_back(std::move(current));
+            current.clear();
+            if (batch.size() >= BATCH_GAMES)
+            {
+                queue.Push(std::move(batch));
+                batch.clear();
+            }
+        };
+
+        while (std::getline(pgn, line))
+        {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+
+            if (!line.empty() && line[0] == '[')
+            {
+                if (inMoves) flushGame();
+                inMoves = false;
+            }
+            else if (line.find_first_not_of(" \t") != std::string::npos)
+                inMoves = true;
+
+            current += line;
+            current += '\n';
+        }
+        flushGame();
+        if (!batch.empty()) queue.Push(std::move(batch));
+        queue.Finish();
+    }
+
+    for (std::thread& t : pool)
+        t.join();
+
+    // K-way merge of the runs, one position (key) at a time
+    std::vector<std::unique_ptr<RunReader>> readers;
+    for (const std::string& path : runs.Paths())
+        readers.push_back(std::make_unique<RunReader>(path));
+
+    auto cmp = [&](size_t a, size_t b) { return RecordLess(readers[b]->Peek(), readers[a]->Peek()); }; // Min heap
+    std::priority_queue<size_t, std::vector<size_t>, decltype(cmp)> heap(cmp);
+    for (size_t r = 0; r < readers.size(); ++r)
+        if (!readers[r]->Done()) heap.push(r);
+
+    std::ofstream out(binPath, std::ios::binary);
+    if (!out)
+    {
+        std::cerr << "Can't write " << binPath << '\n';
+        runs.Remove();
+        return false;
+    }
+
+    uint64_t entries = 0;
+    std::vector<BookRecord> group; // All moves of one position
+
+    auto writeGroup = [&]()
+    {
+        group.erase(std::remove_if(group.begin(), group.end(),
+            [&](const BookRecord& r) { return r.games < options.minGames || r.score == 0; }), group.end());
+        if (group.empty()) return;
+
+        uint32_t maxScore = 0;
+        for (const BookRecord& r : group) maxScore = std::max(maxScore, r.score);
+
+        // Highest weight first, like other Polyglot books
+        std::sort(group.begin(), group.end(), [](const BookRecord& a, const BookRecord& b) { return a.score > b.score; });
+
+        for (const BookRecord& r : group)
+        {
+            uint32_t weight = (maxScore > 65535) ? (uint32_t)((uint64_t)r.score * 65535 / maxScore) : r.score;
+            if (weight == 0) continue;
+
+            // Big endian key, move, weight, learn
+            uint8_t bytes[16] = {};
+            for (int b = 0; b < 8; ++b) bytes[b] = (uint8_t)(r.key >> (56 - 8 * b));
+            bytes[8] = (uint8_t)(r.move >> 8);
+            bytes[9] = (uint8_t)r.move;
+            bytes[10] = (uint8_t)(weight >> 8);
+            bytes[11] = (uint8_t)weight;
+            out.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+            ++entries;
+        }
+    };
+
+    while (!heap.empty())
+    {
+        size_t r = heap.top();
+        heap.pop();
+        BookRecord rec = readers[r]->Peek();
+        readers[r]->Next();
+        if (!readers[r]->Done()) heap.push(r);
+
+        if (!group.empty() && group.back().key == rec.key && group.back().move == rec.move)
+            AddRecord(group.back(), rec);
+        else
+        {
+            if (!group.empty() && group.back().key != rec.key)
+            {
+                writeGroup();
+                group.clear();
+            }
+            group.push_back(rec);
+        }
+    }
+    writeGroup();
+
+    readers.clear();
+    int runCount = (int)runs.Paths().size();
+    runs.Remove();
+
+    BookBuildStats stats;
+    stats.games = games;
+    stats.skipped = skipped;
+    stats.positions = positions;
+    stats.entries = entries;
+    stats.runs = runCount;
+    stats.timeMs = duration_cast<milliseconds>(steady_clock::now() - start).count();
+    if (statsOut) *statsOut = stats;
+
+    std::cerr << "Games: " << stats.games << "  skipped: " << stats.skipped << "  positions: " << stats.positions
+              << "  entries: " << stats.entries << "  runs: " << stats.runs << "  time (ms): " << stats.timeMs << '\n';
+
+    return !writeFailed && (bool)out;
+}
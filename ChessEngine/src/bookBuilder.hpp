@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+struct BookBuildOptions
+{
+    int threads = 1;
+    int maxPly = 24;       // Only positions from the first maxPly plies of each game go in
+    int minGames = 1;      // Moves played in fewer games than this are dropped
+    int memoryMB = 256;    // In memory records before a sorted run gets spilled to disk (all threads together)
+};
+
+struct BookBuildStats
+{
+    uint64_t games = 0;     // Games replayed
+    uint64_t skipped = 0;   // No result or a move that didn't parse
+    uint64_t positions = 0; // Book moves recorded, before merging
+    uint64_t entries = 0;   // Entries written to the .bin
+    int runs = 0;           // Sorted runs spilled to disk
+    long long timeMs = 0;
+};
+
+// Streams a PGN file (it's never fully in memory) through a pool of parser threads and writes a Polyglot book
+// A move scores 2 per win and 1 per draw for the side that played it, weights are scaled to fit 16 bits per position
+// Returns false if a file couldn't be opened or written
+bool BuildBookFromPGN(const std::string& pgnPath, const std::string& binPath, const BookBuildOptions& options, BookBuildStats* stats = nullptr);
@@ -10,17 +10,29 @@
 #include <vector>
 #include <algorithm>
 #include <chrono>
-#include <Windows.h>
-#undef min
-#undef max
+#include <cstring>
 using namespace std::chrono;
 
 constexpr int INF = std::numeric_limits<int>::max() / 4;
 constexpr int MATE_VAL = 1000000;
+// Tablebase wins get their own band below the mate scores: TB_WIN - ply, so anything above
+// TB_WIN_IN_MAX_PLY is a known win but not a mate the search has actually seen
+constexpr int TB_WIN = MATE_VAL - 2 * MAX_PLY;
+constexpr int TB_WIN_IN_MAX_PLY = TB_WIN - MAX_PLY;
+constexpr int TB_WIN_CP = 20000; // What a TB win looks like to the GUI
+static_assert(TB_WIN_IN_MAX_PLY == TT_PLY_SCORE_BOUND, "The TT converts exactly the mate and TB band");
+
+std::string ScoreToUCI(int score)
+{
+	if (std::abs(score) >= MATE_VAL - MAX_PLY)
+		return "mate " + std::to_string(score > 0 ? (MATE_VAL - score + 1) / 2 : -(MATE_VAL + score) / 2);
+	else if (std::abs(score) >= TB_WIN_IN_MAX_PLY)
+		return "cp " + std::to_string(score > 0 ? TB_WIN_CP - (TB_WIN - score) : -TB_WIN_CP + (TB_WIN + score));
+	return "cp " + std::to_string(score);
+}
 
-static Tablebase tb("res/syzygy/");
-
-Bot::Bot(Engine* engine, Color color)
+Bot::Bot(Engine* engine, Color color, int hashMB)
+	: tt(hashMB)
 {
 	this->engine = engine;
 	this->botColor = color;
@@ -110,28 +122,49 @@ void Bot::Clear()
 	quitEarly = false;
 
 	memset(counterMoves, 0, sizeof(counterMoves));
+	memset(killerMoves, 0, sizeof(killerMoves));
+	memset(historyHeuristic, 0, sizeof(historyHeuristic));
 
 	tt.Clear();
+	evalCache.Clear();
+	evalEndgame = GameState::endgame;
 }
 
-Move Bot::GetMoveUCI(int timeForMove)
+Move Bot::GetMoveUCI(const SearchLimits& limits)
 {
-	timePerTurn = timeForMove;
+	this->limits = limits;
 	Move move = GetMove();
 	return move;
 }
 
 Move Bot::GetMove()
 {
-	Move bookMove = GetBookMove(engine, "res/openings.bin");
-	if (!MoveIsNull(bookMove))
+	// Depth/node limited searches skip the (random) book so results are reproducible
+	bool fixedSearch = limits.depth > 0 || limits.nodes > 0;
+	if (!fixedSearch && limits.useBook)
 	{
-		std::cout << "Using opening move\n";
-		return bookMove; // Play instantly
+		Move bookMove = GetOpeningBook().GetMove(engine);
+		if (!MoveIsNull(bookMove))
+		{
+			if (!silent) std::cout << "Using opening move\n";
+			nodesSearched = 0;
+			lastScore = 0;
+			return bookMove; // Play instantly
+		}
 	}
 
 	quitEarly = false;
-	startTime = steady_clock::now();
+	nodesSearched = 0;
+	tbHits = 0;
+	evalProbes = evalCacheHits = ttEvalHits = 0;
+	// The endgame flag isn't in the zobrist key, evals from the other phase would be stale
+	if (evalEndgame != GameState::endgame)
+	{
+		evalCache.Clear();
+		tt.ClearEvals();
+		evalEndgame = GameState::endgame;
+	}
+	timeManager.Init(limits, botColor);
 	tt.NewSearch(); // age TT entries for this root search
 
 	// Clear killer moves before each search
@@ -144,27 +177,35 @@ Move Bot::GetMove()
 				for (int y = 0; y < 64; ++y)
 					historyHeuristic[i][j][x][y] /= 2;
 
-	int maxDepth = 8;
+	int maxDepth = limits.depth > 0 ? std::min(limits.depth, MAX_PLY - 1) : 8;
 	Move bestMove = Move();
 	int bestScore = -INF;
 
-	if (tb.Probeable(engine->GetBitboardBoard()))
+	// In the tables only moves that keep the result get searched, quickest (DTZ) one first
+	std::vector<Move> tbRootMoves;
+	if (GetTablebase().Probeable(engine->GetBitboardBoard()))
 	{
-		return tb.GetMove(engine);
+		Movegen::GetAllMoves(tbRootMoves, botColor, engine->GetBitboardBoard(), engine);
+		tbRootMoves.erase(std::remove_if(tbRootMoves.begin(), tbRootMoves.end(), [&](const Move& m) {
+			engine->MakeMove(m);
+			bool illegal = engine->InCheck(botColor);
+			engine->UndoMove();
+			return illegal;
+		}), tbRootMoves.end());
+
+		if (GetTablebase().FilterRootMoves(engine, tbRootMoves))
+			bestMove = tbRootMoves[0];
+		else
+			tbRootMoves.clear();
 	}
 
 	for (int depth = 1; depth <= maxDepth; ++depth)
 	{
 		//std::cout << "Depth: " << depth << '\n';
-		int alpha = -INF;
-		int beta = INF;
-		bool foundLegal = false;
-
-		Move currentBestMove = Move();
-		int currentBestScore = -INF;
-
 		std::vector<Move> moves = moveLists[0];
 		Movegen::GetAllMoves(moves, botColor, engine->GetBitboardBoard(), engine);
+		if (!tbRootMoves.empty())
+			moves = tbRootMoves;
 		if (!MoveIsNull(bestMove)) // Current best move first to help with pruning
 			OrderMoves(moves, 0, false, bestMove);
 		else
@@ -173,38 +214,9 @@ Move Bot::GetMove()
 			if (!moves.empty()) bestMove = moves[0]; // If not enough time to find move, set default after sorting
 		}
 
-		for (const Move& move : moves)
-		{
-			engine->MakeMove(move);
-
-			if (engine->InCheck(botColor)) { engine->UndoMove(); continue; }
-
-			foundLegal = true;
-
-			int score = -Search(depth - 1, 1, -beta, -alpha);
-
-			engine->UndoMove();
-
-			if (quitEarly)
-				break;
-
-			auto elapsed = duration_cast<milliseconds>(steady_clock::now() - startTime).count();
-			if (elapsed >= timePerTurn)
-			{
-				quitEarly = true;
-				break;
-			}
-
-			if (score > currentBestScore)
-			{
-				currentBestScore = score;
-				currentBestMove = move;
-			}
-
-			alpha = std::max(alpha, currentBestScore);
-			if (alpha >= beta)
-				break;
-		}
+		Move currentBestMove = Move();
+		int currentBestScore = -INF;
+		bool foundLegal = SearchRoot(depth, moves, currentBestMove, currentBestScore);
 
 		if (foundLegal)
 		{
@@ -225,24 +237,66 @@ Move Bot::GetMove()
 			}
 		}
 
+		// MultiPV: every further line searches the root again without the moves already reported,
+		// the TT is warm from the lines before so each one costs a lot less than a fresh search
+		std::vector<std::pair<Move, int>> lines = { { bestMove, bestScore } };
+		std::vector<Move> remaining = moves;
+		for (int pv = 1; pv < limits.multiPV && !quitEarly; ++pv)
+		{
+			remaining.erase(std::remove(remaining.begin(), remaining.end(), lines.back().first), remaining.end());
+
+			Move lineMove = Move();
+			int lineScore = -INF;
+			if (!SearchRoot(depth, remaining, lineMove, lineScore) || quitEarly)
+				break;
+			lines.push_back({ lineMove, lineScore });
+		}
+
+		// Each line got its own full window search, a later one can come out ahead of the first,
+		// report them best first and play whatever ends up on top so multipv 1 matches bestmove
+		std::stable_sort(lines.begin(), lines.end(), [](const std::pair<Move, int>& a, const std::pair<Move, int>& b) {
+			return a.second > b.second;
+		});
+		bestMove = lines[0].first;
+		bestScore = lines[0].second;
+
+		if (GameState::uci && !silent)
+		{
+			auto elapsed = timeManager.Elapsed();
+			for (size_t pv = 0; pv < lines.size(); ++pv)
+			{
+				std::cout << "info depth " << depth;
+				if (limits.multiPV > 1)
+					std::cout << " multipv " << (pv + 1);
+				std::cout << " score " << ScoreToUCI(lines[pv].second);
+				std::cout << " nodes " << nodesSearched << " time " << elapsed
+					<< " nps " << (nodesSearched * 1000 / (elapsed + 1))
+					<< " tbhits " << tbHits
+					<< " pv " << MoveToUCI(lines[pv].first) << std::endl;
+			}
+		}
+
+		// Ran out of time in one of the extra lines, the best move is still from a complete iteration
+		if (quitEarly)
+			break;
+
 		// Extradite mate for bot
 		// Cast to avoid integer overflow
 		if ((long long)bestScore >= (MATE_VAL - MAX_PLY))
 			break;
 
-		auto elapsed = duration_cast<milliseconds>(steady_clock::now() - startTime).count();
-		// Keep searching until limit
-		if (depth == maxDepth)
-			if (elapsed < timePerTurn)
-				++maxDepth;
-
-		// Stop searching if time limit is reached
-		if (elapsed >= timePerTurn)
+		// Stop if another iteration isn't worth starting (stable best move, out of soft time, etc.)
+		if (timeManager.StopAfterIteration(depth, bestMove, bestScore))
 			break;
+
+		// Keep searching until limit, a fixed depth is never extended
+		if (limits.depth <= 0 && depth == maxDepth && maxDepth < MAX_PLY - 1)
+			++maxDepth;
 	}
 
-	std::cout << "Making " << MoveToUCI(bestMove) << " with score " << bestScore << '\n';
-	nodesSearched = 0;
+	lastScore = bestScore;
+	if (!GameState::uci && !silent)
+		std::cout << "Making " << MoveToUCI(bestMove) << " with score " << bestScore << '\n';
 
 	Piece movingPiece = engine->GetBoard()[GetStart(bestMove)].GetPiece();
 	if (!engine->ValidMove(movingPiece, bestMove)) throw "Invalid move";
@@ -253,18 +307,87 @@ Move Bot::GetMove()
 		throw "Move was null\n";
 }
 
-int Bot::Search(int depth, int ply, int alpha, int beta)
+bool Bot::SearchRoot(int depth, const std::vector<Move>& moves, Move& bestMoveOut, int& bestScoreOut)
 {
-	++nodesSearched;
-	// Check time every 512 nodes (& faster than %)
-	if ((nodesSearched & 511) == 0)
+	int alpha = -INF;
+	int beta = INF;
+	bool foundLegal = false;
+
+	for (const Move& move : moves)
 	{
-		auto elapsed = duration_cast<milliseconds>(steady_clock::now() - startTime).count();
-		if (elapsed >= timePerTurn)
+		engine->MakeMove(move);
+
+		if (engine->InCheck(botColor)) { engine->UndoMove(); continue; }
+
+		foundLegal = true;
+
+		int score = -Search(depth - 1, 1, -beta, -alpha);
+
+		engine->UndoMove();
+
+		if (quitEarly)
+			break;
+
+		if (ShouldStop())
 		{
 			quitEarly = true;
-			return alpha;
+			break;
 		}
+
+		if (score > bestScoreOut)
+		{
+			bestScoreOut = score;
+			bestMoveOut = move;
+		}
+
+		alpha = std::max(alpha, bestScoreOut);
+		if (alpha >= beta)
+			break;
+	}
+	return foundLegal;
+}
+
+bool Bot::ShouldStop()
+{
+	// Node budget is checked every node so fixed-node searches are exact
+	if (limits.nodes > 0 && nodesSearched >= (uint64_t)limits.nodes)
+		return true;
+
+	// Check time and stop requests every 512 nodes (& faster than %)
+	if ((nodesSearched & 511) == 0)
+		return timeManager.HardLimitReached() || (limits.stop && limits.stop->load(std::memory_order_relaxed));
+
+	return false;
+}
+
+int Bot::StaticEval(uint64_t key)
+{
+	++evalProbes;
+	int eval;
+	if (tt.ttProbeEval(key, eval))
+	{
+		++ttEvalHits;
+		return eval;
+	}
+	if (evalCache.Probe(key, eval))
+	{
+		++evalCacheHits;
+		return eval;
+	}
+
+	eval = Eval(GameState::currentPlayer, engine);
+	evalCache.Store(key, eval);
+	tt.ttStoreEval(key, eval); // Most evals happen in Qsearch and early outs that don't store, attach it if the position is there
+	return eval;
+}
+
+int Bot::Search(int depth, int ply, int alpha, int beta)
+{
+	++nodesSearched;
+	if (ShouldStop())
+	{
+		quitEarly = true;
+		return alpha;
 	}
 
 	bool followingNullMove = afterNullMove; // Used for this search only
@@ -275,9 +398,12 @@ int Bot::Search(int depth, int ply, int alpha, int beta)
 
 	if (depth <= 0 || engine->IsOver()) return Qsearch(alpha, beta, 1);
 
+	uint64_t key = engine->GetZobristKey();
+	int staticEval = TT_NO_EVAL; // Handed to the TT store below if it got computed
+
 	if (!pvNode && !engine->InCheck(GameState::currentPlayer))
 	{
-		int eval = Eval(GameState::currentPlayer, engine);
+		int eval = staticEval = StaticEval(key);
 
 		// Razoring
 		const int RAZORING_MARGIN = 300;
@@ -293,17 +419,13 @@ int Bot::Search(int depth, int ply, int alpha, int beta)
 		if (depth <= 3 && eval + futility_margin[depth] <= alpha)
 		{
 			std::vector<Move> moves = Movegen::GetAllMoves(GameState::currentPlayer, engine->GetBitboardBoard(), engine);
+			const AttackInfo& attacks = engine->GetAttackInfo();
 
 			// Only prune quiet moves
 			for (const Move& move : moves)
 			{
-				bool givesCheck = false;
-				engine->MakeMove(move);
-				if (engine->InCheck(GameState::currentPlayer)) // Opponent
-					givesCheck = true;
-				engine->UndoMove();
-
-				if (MoveIsCapture(move, engine->GetBitboardBoard()) || GetPromotion(move) != 0 || givesCheck)
+				if (MoveIsCapture(move, engine->GetBitboardBoard()) || GetPromotion(move) != 0 ||
+					Movegen::GivesCheck(move, engine->GetBitboardBoard(), attacks))
 					continue;
 
 				engine->MakeMove(move);
@@ -317,12 +439,34 @@ int Bot::Search(int depth, int ply, int alpha, int beta)
 		}
 	}
 
-	uint64_t key = engine->GetZobristKey();
 	int ttScore;
 	uint32_t ttMove;
-	if (tt.ttProbe(key, depth, alpha, beta, ttScore, ttMove))
+	if (tt.ttProbe(key, depth, ply, alpha, beta, ttScore, ttMove))
 		return ttScore;
 
+	// Tablebase lookup, only right after a capture or pawn move since that's when the piece count can
+	// drop into the tables and the 50 move counter is 0 (what WDL tables assume)
+	const Tablebase& tb = GetTablebase();
+	if (engine->LastMoveZeroing() && tb.SearchProbeable(engine->GetBitboardBoard(), depth))
+	{
+		int wdl = tb.ProbeWDL(engine);
+		if (wdl != -99)
+		{
+			++tbHits;
+
+			// A win is only a lower bound (there could be a mate), a loss an upper bound
+			int tbScore = wdl > 0 ? TB_WIN - ply : (wdl < 0 ? -TB_WIN + ply : 0);
+			uint8_t tbFlag = wdl > 0 ? TT_BETA : (wdl < 0 ? TT_ALPHA : TT_EXACT);
+
+			if (tbFlag == TT_EXACT || (tbFlag == TT_BETA ? tbScore >= beta : tbScore <= alpha))
+			{
+				// Stored deeper than searched, it's as good as a full search
+				tt.ttStore(key, std::min(depth + 6, MAX_PLY - 1), ply, tbScore, 0, tbFlag);
+				return tbScore;
+			}
+		}
+	}
+
 	Color movingColor = GameState::currentPlayer;
 	bool foundLegal = false;
 
@@ -381,12 +525,11 @@ int Bot::Search(int depth, int ply, int alpha, int beta)
 	std::vector<Move>& moves = moveLists[ply];
 	moves.clear();
 
+	const AttackInfo& attacks = engine->GetAttackInfo();
 	for (const Move& move : pseudoMoves)
 	{
-		engine->MakeMove(move);
-		if (!engine->InCheck(movingColor))
+		if (Movegen::IsLegal(move, engine->GetBitboardBoard(), attacks))
 			moves.push_back(move);
-		engine->UndoMove();
 	}
 
 	OrderMoves(moves, ply, false);
@@ -487,28 +630,24 @@ int Bot::Search(int depth, int ply, int alpha, int beta)
 	else if (bestScore >= beta) flag = TT_BETA;
 	else flag = TT_EXACT;
 
-	tt.ttStore(key, depth, bestScore, bestMove32, flag);
+	tt.ttStore(key, depth, ply, bestScore, bestMove32, flag, staticEval);
 	return bestScore;
 }
 
 int Bot::Qsearch(int alpha, int beta, int ply)
 {
 	++nodesSearched;
-	if ((nodesSearched & 511) == 0) // Check time every 512 nodes
+	if (ShouldStop())
 	{
-		auto elapsed = duration_cast<milliseconds>(steady_clock::now() - startTime).count();
-		if (elapsed >= timePerTurn)
-		{
-			quitEarly = true;
-			return alpha;
-		}
+		quitEarly = true;
+		return alpha;
 	}
 
 	int standPat = 0;
 
 	//try
 	//{
-		standPat = Eval(GameState::currentPlayer, engine);
+		standPat = StaticEval(engine->GetZobristKey());
 	//}
 	//catch (...)
 	//{
@@ -534,9 +673,15 @@ int Bot::Qsearch(int alpha, int beta, int ply)
 	std::vector<Move> moves = qMoveLists[ply];
 	Movegen::GetAllMoves(moves, movingColor, engine->GetBitboardBoard(), engine, onlyNoisy);
 	OrderMoves(moves, 0, true);
+	const AttackInfo& attacks = engine->GetAttackInfo();
 
 	for (const Move& move : moves)
 	{
+		// Captures that lose material once everything's traded off
+		if (GetPromotion(move) == 0 && MoveIsCapture(move, engine->GetBitboardBoard()) &&
+			Movegen::SEE(move, engine->GetBitboardBoard(), attacks) < 0)
+			continue;
+
 		engine->MakeMove(move);
 		if (engine->InCheck(Opponent(GameState::currentPlayer))) // Skip illegal moves
 		{
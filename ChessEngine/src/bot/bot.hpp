@@ -2,38 +2,63 @@
 
 #include <chrono>
 #include <vector>
+#include <string>
 
 #include "opening.hpp"
+#include "timeManager.hpp"
 
 #include "core/piece.hpp"
 #include "core/boardCalculator.hpp"
 #include "core/engine.hpp"
-#include "core/tt.hpp"
+#include "core/TT.hpp"
+#include "core/evalCache.hpp"
 #include "core/eval.hpp"
 #include "graphics/graphicsEngine.hpp"
 
 #define MAX_PLY 128
 #define NUM_PIECES 6
 
+// "cp 25", "mate -3", tablebase wins show as cp +-20000
+std::string ScoreToUCI(int score);
+
 class Bot
 {
 public:
-	Bot(Engine* engine, Color color);
+	Bot(Engine* engine, Color color, int hashMB = 128);
 	Move GetMove();
-	Move GetMoveUCI(int timeForMove);
+	Move GetMoveUCI(const SearchLimits& limits);
 	void SetColor(Color color);
 	const Color GetColor() const { return botColor; }
+	// Nodes searched by the last GetMove call
+	uint64_t GetNodesSearched() const { return nodesSearched; }
+	uint64_t GetTBHits() const { return tbHits; }
+	// Static evals asked for by the last search, and how many came from the TT or the eval cache instead of Eval()
+	uint64_t GetEvalProbes() const { return evalProbes; }
+	uint64_t GetEvalCacheHits() const { return evalCacheHits; }
+	uint64_t GetTTEvalHits() const { return ttEvalHits; }
+	// Score of the last GetMove call from the mover's side (0 for book moves)
+	int GetLastScore() const { return lastScore; }
+	// No info/"Making" output, for batch runs that print their own results
+	void SetSilent(bool silent) { this->silent = silent; }
 
 	void Clear();
 
 private:
+	// GUI games get a fixed amount of time per move
+	static SearchLimits DefaultLimits() { SearchLimits l; l.moveTime = 12000; l.moveOverhead = 0; return l; }
+
+	bool ShouldStop(); // Node/time limit check, called once per node
+	// Full window search over the given root moves, false if none of them were legal
+	bool SearchRoot(int depth, const std::vector<Move>& moves, Move& bestMove, int& bestScore);
 	int Search(int depth, int ply, int alpha, int beta);
 	int Qsearch(int alpha, int beta, int ply);
+	int StaticEval(uint64_t key); // Eval for the side to move, from the TT or eval cache if they have it
 	int ScoreMove(const Move move, int ply, bool onlyMVVLVA);
 	void OrderMoves(std::vector<Move>& moves, int ply, bool onlyMVVLVA, Move firstMove = Move());
 
 
 	TranspositionTable tt;
+	EvalCache evalCache;
 	// [color][pieces][start square][end square]
 	int historyHeuristic[2][NUM_PIECES][64][64] = { 0 };
 	Engine* engine;
@@ -43,11 +68,18 @@ private:
 	std::vector<Move> qMoveLists[MAX_PLY];
 	Move killerMoves[MAX_PLY][2];
 	Move counterMoves[2][64][64];
-	// Start time of the search, used for time control
-	std::chrono::time_point<std::chrono::steady_clock> startTime;
-	int nodesSearched;
+	// Time control for the current search
+	TimeManager timeManager;
+	SearchLimits limits = DefaultLimits();
+	uint64_t nodesSearched = 0;
+	uint64_t tbHits = 0;
+	uint64_t evalProbes = 0;
+	uint64_t evalCacheHits = 0;
+	uint64_t ttEvalHits = 0;
+	bool evalEndgame = false; // GameState::endgame the cached evals were made with, Eval's king PST depends on it
+	int lastScore = 0;
+	bool silent = false;
 	int extensionsThisSearch = 0;
-	int timePerTurn = 12000; // In milliseconds
 	bool quitEarly = false;
 	bool afterNullMove = false;
 };
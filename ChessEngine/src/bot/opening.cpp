@@ -7,98 +7,85 @@
 #include <vector>
 #include <cstdint>
 
-struct PolyglotEntry
-{
-    uint64_t key;
-    uint16_t move;
-    uint16_t weight;
-    uint16_t learn;
-};
+constexpr size_t POLYGLOT_ENTRY_SIZE = 16; // key 8, move 2, weight 2, learn 4
 
-uint64_t Swap64(uint64_t x)
+static uint64_t ReadBE64(const uint8_t* p)
 {
-    return  ((x & 0xFF00000000000000ULL) >> 56) |
-            ((x & 0x00FF000000000000ULL) >> 40) |
-            ((x & 0x0000FF0000000000ULL) >> 24) |
-            ((x & 0x000000FF00000000ULL) >> 8)  |
-            ((x & 0x00000000FF000000ULL) << 8)  |
-            ((x & 0x0000000000FF0000ULL) << 24) |
-            ((x & 0x000000000000FF00ULL) << 40) |
-            ((x & 0x00000000000000FFULL) << 56);
+    uint64_t x = 0;
+    for (int i = 0; i < 8; ++i)
+        x = (x << 8) | p[i];
+    return x;
 }
 
-uint16_t Swap16(uint16_t x) { return (x >> 8) | (x << 8); }
+static uint16_t ReadBE16(const uint8_t* p) { return (uint16_t)((p[0] << 8) | p[1]); }
 
-std::vector<BookMove> LookupPolyglot(const std::string& filename, uint64_t searchKey)
+OpeningBook::~OpeningBook()
 {
-    std::ifstream file(filename, std::ios::binary | std::ios::ate);
-    if (!file) return {};
+    Close();
+}
 
-    std::streamsize size = file.tellg();
-    size_t count = size / 16;
-    size_t lo = 0, hi = count - 1;
+bool OpeningBook::Open(const std::string& newPath)
+{
+    Close();
+    path = newPath;
+    if (!file.Open(path, MappedFile::Access::RANDOM)) return false; // Binary search, read ahead doesn't help
 
-    // Binary search for first matching key
-    while (lo <= hi)
+    if (file.Size() < POLYGLOT_ENTRY_SIZE)
     {
-        size_t mid = (lo + hi) / 2;
-        file.seekg(mid * 16);
-        uint64_t rawKey;
-        file.read(reinterpret_cast<char*>(&rawKey), 8);
-        uint64_t key = Swap64(rawKey);
+        file.Close();
+        return false;
+    }
+    entries = file.Data();
+    count = file.Size() / POLYGLOT_ENTRY_SIZE;
+    return true;
+}
+
+void OpeningBook::Close()
+{
+    file.Close();
+    entries = nullptr;
+    count = 0;
+}
 
-        if (key < searchKey)      lo = mid + 1;
-        else if (key > searchKey) hi = mid - 1;
+std::vector<BookMove> OpeningBook::Lookup(uint64_t key) const
+{
+    std::vector<BookMove> moves;
+    if (!entries) return moves;
 
-        else
-        {
-            // Found one, now collect all consecutive entries with same key
-            std::vector<BookMove> moves;
-
-            // Scan backwards
-            size_t idx = mid;
-            while (idx > 0)
-            {
-                file.seekg((idx - 1) * 16);
-                uint64_t rk; file.read(reinterpret_cast<char*>(&rk), 8);
-                if (Swap64(rk) != searchKey) break;
-                idx--;
-            }
-
-            // Scan forwards
-            for (; idx < count; idx++)
-            {
-                file.seekg(idx * 16);
-                PolyglotEntry e;
-                file.read(reinterpret_cast<char*>(&e.key), 8);
-                file.read(reinterpret_cast<char*>(&e.move), 2);
-                file.read(reinterpret_cast<char*>(&e.weight), 2);
-                file.read(reinterpret_cast<char*>(&e.learn), 2);
-                file.ignore(2);
-
-                if (Swap64(e.key) != searchKey) break;
-                moves.push_back({ Swap16(e.move), Swap16(e.weight) });
-            }
-            return moves;
-        }
+    // First entry with a key >= the one we want
+    size_t lo = 0, hi = count;
+    while (lo < hi)
+    {
+        size_t mid = lo + (hi - lo) / 2;
+        if (ReadBE64(entries + mid * POLYGLOT_ENTRY_SIZE) < key) lo = mid + 1;
+        else hi = mid;
     }
-    return {};
+
+    for (size_t i = lo; i < count; ++i)
+    {
+        const uint8_t* e = entries + i * POLYGLOT_ENTRY_SIZE;
+        if (ReadBE64(e) != key) break;
+        moves.push_back({ ReadBE16(e + 8), ReadBE16(e + 10) });
+    }
+    return moves;
 }
 
-std::mt19937 rng(std::random_device{}());
-Move GetBookMove(Engine* engine, const std::string& filename)
+static std::mt19937 rng(std::random_device{}());
+Move OpeningBook::GetMove(Engine* engine)
 {
-    uint64_t key = engine->ComputeFullHash();
-    auto entries = LookupPolyglot(filename, key);
-    if (entries.empty()) return Move();
+    if (!entries || engine->GetGamePly() >= maxPly) return Move();
+
+    auto moves = Lookup(engine->GetZobristKey()); // The search key is the Polyglot key
+    if (moves.empty()) return Move();
 
     int total = 0;
-    for (auto& bm : entries) total += bm.weight;
+    for (auto& bm : moves) total += bm.weight;
+    if (total <= 0) return PolyglotToMove(moves[0].move, engine);
 
     std::uniform_int_distribution<int> dist(0, total - 1);
     int r = dist(rng);
 
-    for (auto& bm : entries)
+    for (auto& bm : moves)
     {
         if (r < bm.weight)
             return PolyglotToMove(bm.move, engine);
@@ -107,6 +94,14 @@ Move GetBookMove(Engine* engine, const std::string& filename)
     return Move();
 }
 
+OpeningBook& GetOpeningBook()
+{
+    static OpeningBook book;
+    static const bool triedDefault = book.Open("res/openings.bin");
+    (void)triedDefault;
+    return book;
+}
+
 Move PolyglotToMove(uint16_t pmove, Engine* engine)
 {
     int to = pmove & 0x3F;
@@ -155,3 +150,27 @@ Move PolyglotToMove(uint16_t pmove, Engine* engine)
     return EncodeMove(fromSq, toSq, static_cast<int>(promotion), wasEnPassant, wasCastle);
 }
 
+uint16_t MoveToPolyglot(Move move)
+{
+    int from = GetStart(move);
+    int to = GetEnd(move);
+
+    if (IsCastle(move))
+        to = ToIndex(ToRow(to), ToCol(to) == 6 ? 7 : 0); // King lands on the rook square
+
+    // Engine 0 = a8, Polyglot 0 = a1
+    int pFrom = from ^ 56;
+    int pTo = to ^ 56;
+
+    int promo = 0;
+    switch ((Pieces)GetPromotion(move))
+    {
+    case Pieces::KNIGHT: promo = 1; break;
+    case Pieces::BISHOP: promo = 2; break;
+    case Pieces::ROOK:   promo = 3; break;
+    case Pieces::QUEEN:  promo = 4; break;
+    default: break;
+    }
+
+    return (uint16_t)((promo << 12) | (pFrom << 6) | pTo);
+}
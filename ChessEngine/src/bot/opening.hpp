@@ -1,9 +1,12 @@
 #pragma once
 
 #include <cstdint>
+#include <string>
+#include <vector>
 
 #include "core/move.hpp"
 #include "core/engine.hpp"
+#include "core/mappedFile.hpp"
 
 struct BookMove
 {
@@ -11,5 +14,39 @@ struct BookMove
     uint16_t weight; // Frequency
 };
 
-Move GetBookMove(Engine* engine, const std::string& filename);
-Move PolyglotToMove(uint16_t pmove, Engine* engine);
\ No newline at end of file
+// Polyglot .bin book, mapped into memory once and binary searched in place
+class OpeningBook
+{
+public:
+    OpeningBook() = default;
+    ~OpeningBook();
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    // Closes whatever was open first, an empty path just leaves the book off
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return entries != nullptr; }
+    const std::string& GetPath() const { return path; }
+    size_t Size() const { return count; }
+
+    std::vector<BookMove> Lookup(uint64_t key) const;
+
+    // Weighted random book move, null if out of book or past maxPly
+    Move GetMove(Engine* engine);
+
+    int maxPly = 255; // Only use the book for this many plies of the game (UCI Book Depth)
+
+private:
+    std::string path;
+    MappedFile file;
+    const uint8_t* entries = nullptr; // 16 byte big endian records sorted by key
+    size_t count = 0;
+};
+
+// Shared by every bot, opens res/openings.bin the first time it's asked for unless a path was set
+OpeningBook& GetOpeningBook();
+
+Move PolyglotToMove(uint16_t pmove, Engine* engine);
+// Inverse of PolyglotToMove, castling is written king takes own rook (e1h1) like Polyglot wants
+uint16_t MoveToPolyglot(Move move);
\ No newline at end of file
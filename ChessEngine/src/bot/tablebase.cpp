@@ -1,235 +1,151 @@
 #include "tablebase.hpp"
 
+#if defined(CHESS_NO_TABLEBASE)
+
+// Built without Fathom (CMake couldn't find include/Fathom), nothing is ever probeable
+
+Tablebase::Tablebase(const std::string& path) : ok(false) {}
+
+Tablebase::~Tablebase() {}
+
+bool Tablebase::Initialized() const { return false; }
+
+bool Tablebase::Probeable(const BitboardBoard& board) const { return false; }
+
+bool Tablebase::SearchProbeable(const BitboardBoard& board, int depth) const { return false; }
+
+int Tablebase::ProbeWDL(Engine* engine) const { return -99; }
+
+int Tablebase::ProbeDTZ(Engine* engine) const { return -99; }
+
+Move Tablebase::GetMove(Engine* engine) const { return Move(); }
+
+bool Tablebase::FilterRootMoves(Engine* engine, std::vector<Move>& moves) const { return false; }
+
+Tablebase& GetTablebase()
+{
+	static Tablebase tb("res/syzygy/");
+	return tb;
+}
+
+#else
+
 extern "C" {
 #include "Fathom/src/tbprobe.h"
 }
 
 #include <iostream>
 #include <cstdint>
+#include <algorithm>
 
-#include "core/gamestate.hpp"
+#include "core/gameState.hpp"
 #include "core/bitboard.hpp"
-
-#define BOARD_RANK_1            0x00000000000000FFull
-#define BOARD_FILE_A            0x8080808080808080ull
-#define square(r, f)            (8 * (r) + (f))
-#define rank(s)                 ((s) >> 3)
-#define file(s)                 ((s) & 0x07)
-#define board(s)                ((uint64_t)1 << (s))
+#include "core/movegen.hpp"
 
 inline unsigned flipSquareVertical(unsigned sq)
 {
     return ((sq ^ 56) & 56) | (sq & 7);
 }
 
-struct pos
+// Position in Fathom's layout (a1 = bit 0), our bitboards have a8 as bit 0 so every one is flipped
+struct TBPosition
 {
-    uint64_t white;
-    uint64_t black;
-    uint64_t kings;
-    uint64_t queens;
-    uint64_t rooks;
-    uint64_t bishops;
-    uint64_t knights;
-    uint64_t pawns;
-    uint8_t castling;
-    uint8_t rule50;
-    uint8_t ep;
-    bool turn;
-    uint16_t move;
+	uint64_t white, black;
+	uint64_t kings, queens, rooks, bishops, knights, pawns;
+	unsigned rule50;
+	unsigned castling;
+	unsigned ep;
+	bool turn; // true = white
 };
 
-static bool parse_FEN(struct pos* pos, const char* fen)
+static TBPosition ToTBPosition(Engine* engine)
+{
+	const BitboardBoard& board = engine->GetBitboardBoard();
+	auto pieces = [&](Pieces type) {
+		int t = (int)type - 1;
+		return FlipVertical(board.pieceBitboards[0][t] | board.pieceBitboards[1][t]);
+	};
+
+	TBPosition pos;
+	pos.white = FlipVertical(board.allPieces[0]);
+	pos.black = FlipVertical(board.allPieces[1]);
+	pos.kings = pieces(Pieces::KING);
+	pos.queens = pieces(Pieces::QUEEN);
+	pos.rooks = pieces(Pieces::ROOK);
+	pos.bishops = pieces(Pieces::BISHOP);
+	pos.knights = pieces(Pieces::KNIGHT);
+	pos.pawns = pieces(Pieces::PAWN);
+	pos.rule50 = (unsigned)GameState::halfmoves;
+	pos.turn = IsWhite(GameState::currentPlayer);
+
+	pos.castling = 0;
+	if (GameState::whiteCastlingRights[1]) pos.castling |= TB_CASTLING_K;
+	if (GameState::whiteCastlingRights[0]) pos.castling |= TB_CASTLING_Q;
+	if (GameState::blackCastlingRights[1]) pos.castling |= TB_CASTLING_k;
+	if (GameState::blackCastlingRights[0]) pos.castling |= TB_CASTLING_q;
+
+	// Like Fathom's own FEN parser, only pass the ep square if it can actually be taken
+	pos.ep = 0;
+	int ep = GameState::enPassantTarget;
+	if (ep > 0)
+	{
+		int us = pos.turn ? 0 : 1;
+		if (Movegen::GetPawnAttacks()[1 - us][ep] & board.pieceBitboards[us][(int)Pieces::PAWN - 1])
+			pos.ep = flipSquareVertical(ep);
+	}
+	return pos;
+}
+
+// results (optional) gets one entry per legal move, ended by TB_RESULT_FAILED
+static unsigned ProbeRoot(Engine* engine, unsigned* results = NULL)
 {
-    uint64_t white = 0, black = 0;
-    uint64_t kings, queens, rooks, bishops, knights, pawns;
-    kings = queens = rooks = bishops = knights = pawns = 0;
-    bool turn;
-    unsigned rule50 = 0, move = 1;
-    unsigned ep = 0;
-    unsigned castling = 0;
-    char c;
-    int r, f;
-
-    if (fen == NULL)
-        goto fen_parse_error;
-
-    for (r = 7; r >= 0; r--)
-    {
-        for (f = 0; f <= 7; f++)
-        {
-            unsigned s = (r * 8) + f;
-            uint64_t b = board(s);
-            c = *fen++;
-            switch (c)
-            {
-            case 'k':
-                kings |= b;
-                black |= b;
-                continue;
-            case 'K':
-                kings |= b;
-                white |= b;
-                continue;
-            case 'q':
-                queens |= b;
-                black |= b;
-                continue;
-            case 'Q':
-                queens |= b;
-                white |= b;
-                continue;
-            case 'r':
-                rooks |= b;
-                black |= b;
-                continue;
-            case 'R':
-                rooks |= b;
-                white |= b;
-                continue;
-            case 'b':
-                bishops |= b;
-                black |= b;
-                continue;
-            case 'B':
-                bishops |= b;
-                white |= b;
-                continue;
-            case 'n':
-                knights |= b;
-                black |= b;
-                continue;
-            case 'N':
-                knights |= b;
-                white |= b;
-                continue;
-            case 'p':
-                pawns |= b;
-                black |= b;
-                continue;
-            case 'P':
-                pawns |= b;
-                white |= b;
-                continue;
-            default:
-                break;
-            }
-            if (c >= '1' && c <= '8')
-            {
-                unsigned jmp = (unsigned)c - '0';
-                f += jmp - 1;
-                continue;
-            }
-            goto fen_parse_error;
-        }
-        if (r == 0)
-            break;
-        c = *fen++;
-        if (c != '/')
-            goto fen_parse_error;
-    }
-    c = *fen++;
-    if (c != ' ')
-        goto fen_parse_error;
-    c = *fen++;
-    if (c != 'w' && c != 'b')
-        goto fen_parse_error;
-    turn = (c == 'w');
-    c = *fen++;
-    if (c != ' ')
-        goto fen_parse_error;
-    c = *fen++;
-    if (c != '-')
-    {
-        do
-        {
-            switch (c)
-            {
-            case 'K':
-                castling |= TB_CASTLING_K; break;
-            case 'Q':
-                castling |= TB_CASTLING_Q; break;
-            case 'k':
-                castling |= TB_CASTLING_k; break;
-            case 'q':
-                castling |= TB_CASTLING_q; break;
-            default:
-                goto fen_parse_error;
-            }
-            c = *fen++;
-        } while (c != ' ');
-        fen--;
-    }
-    c = *fen++;
-    if (c != ' ')
-        goto fen_parse_error;
-    c = *fen++;
-    if (c >= 'a' && c <= 'h')
-    {
-        unsigned file = c - 'a';
-        c = *fen++;
-        if (c != '3' && c != '6')
-            goto fen_parse_error;
-        unsigned rank = c - '1';
-        ep = square(rank, file);
-        if (rank == 2 && turn)
-            goto fen_parse_error;
-        if (rank == 5 && !turn)
-            goto fen_parse_error;
-        if (rank == 2 && ((tb_pawn_attacks(ep, true) & (black & pawns)) == 0))
-            ep = 0;
-        if (rank == 5 && ((tb_pawn_attacks(ep, false) & (white & pawns)) == 0))
-            ep = 0;
-    }
-    else if (c != '-')
-        goto fen_parse_error;
-    c = *fen++;
-    if (c != ' ')
-        goto fen_parse_error;
-    char clk[4];
-    clk[0] = *fen++;
-    if (clk[0] < '0' || clk[0] > '9')
-        goto fen_parse_error;
-    clk[1] = *fen++;
-    if (clk[1] != ' ')
-    {
-        if (clk[1] < '0' || clk[1] > '9')
-            goto fen_parse_error;
-        clk[2] = *fen++;
-        if (clk[2] != ' ')
-        {
-            if (clk[2] < '0' || clk[2] > '9')
-                goto fen_parse_error;
-            c = *fen++;
-            if (c != ' ')
-                goto fen_parse_error;
-            clk[3] = '\0';
-        }
-        else
-            clk[2] = '\0';
-    }
-    else
-        clk[1] = '\0';
-    rule50 = atoi(clk);
-    move = atoi(fen);
-
-    pos->white = white;
-    pos->black = black;
-    pos->kings = kings;
-    pos->queens = queens;
-    pos->rooks = rooks;
-    pos->bishops = bishops;
-    pos->knights = knights;
-    pos->pawns = pawns;
-    pos->castling = castling;
-    pos->rule50 = rule50;
-    pos->ep = ep;
-    pos->turn = turn;
-    pos->move = move;
-    return true;
-
-fen_parse_error:
-    return false;
+	TBPosition pos = ToTBPosition(engine);
+	if (pos.castling != 0)
+		return TB_RESULT_FAILED;
+
+	return tb_probe_root(pos.white, pos.black, pos.kings, pos.queens, pos.rooks, pos.bishops, pos.knights, pos.pawns,
+		pos.rule50, pos.castling, pos.ep, pos.turn, results);
+}
+
+static Pieces PromotionFromTB(unsigned promo)
+{
+	if (promo == TB_PROMOTES_QUEEN) return Pieces::QUEEN;
+	else if (promo == TB_PROMOTES_ROOK) return Pieces::ROOK;
+	else if (promo == TB_PROMOTES_BISHOP) return Pieces::BISHOP;
+	else if (promo == TB_PROMOTES_KNIGHT) return Pieces::KNIGHT;
+	return Pieces::NONE;
+}
+
+// Our move for a Fathom result, matched by squares and promotion so ep flags come from our movegen
+static Move FindMove(unsigned result, const std::vector<Move>& moves)
+{
+	int from = flipSquareVertical(TB_GET_FROM(result));
+	int to = flipSquareVertical(TB_GET_TO(result));
+	int promo = (int)PromotionFromTB(TB_GET_PROMOTES(result));
+
+	for (const Move& m : moves)
+		if (GetStart(m) == from && GetEnd(m) == to && GetPromotion(m) == promo)
+			return m;
+	return Move();
+}
+
+static void GenerateLegal(Engine* engine, std::vector<Move>& moves)
+{
+	Color us = GameState::currentPlayer;
+	moves.clear();
+	Movegen::GetAllMoves(moves, us, engine->GetBitboardBoard(), engine);
+
+	size_t legal = 0;
+	for (size_t i = 0; i < moves.size(); ++i)
+	{
+		engine->MakeMove(moves[i]);
+		bool inCheck = engine->InCheck(us);
+		engine->UndoMove();
+
+		if (!inCheck)
+			moves[legal++] = moves[i];
+	}
+	moves.resize(legal);
 }
 
 Tablebase::Tablebase(const std::string& path)
@@ -259,66 +175,40 @@ bool Tablebase::Probeable(const BitboardBoard& board) const
 	return Initialized() && enoughPieces;
 }
 
+bool Tablebase::SearchProbeable(const BitboardBoard& board, int depth) const
+{
+	if (depth < probeDepth || !Initialized())
+		return false;
+
+	int allPieces = PopCount64(board.occupied);
+	return allPieces <= probeLimit && allPieces <= (int)TB_LARGEST;
+}
+
 int Tablebase::ProbeWDL(Engine* engine) const
 {
-    std::string fen = engine->GetFEN();
-    struct pos pos0;
-    struct pos* pos = &pos0;
-    if (!parse_FEN(pos, fen.c_str()))
-        return false;
-
-    unsigned result = tb_probe_root(
-        pos->white,
-        pos->black,
-        pos->kings,
-        pos->queens,
-        pos->rooks,
-        pos->bishops,
-        pos->knights,
-        pos->pawns,
-        pos->rule50,
-        pos->castling,
-        pos->ep,
-        pos->turn,
-        NULL
-    );
-
-    int wdl = TB_GET_WDL(result);
+	TBPosition pos = ToTBPosition(engine);
+	if (pos.castling != 0)
+		return -99; // Tables don't have castling
+
+	// rule50 = 0, tb_probe_wdl refuses anything else and the result doesn't depend on it anyway
+	unsigned wdl = tb_probe_wdl(pos.white, pos.black, pos.kings, pos.queens, pos.rooks, pos.bishops, pos.knights, pos.pawns,
+		0, 0, pos.ep, pos.turn);
 
 	if (wdl == TB_RESULT_FAILED)
 		return -99;
 
-	if (wdl == TB_LOSS || wdl == TB_BLESSED_LOSS)
+	if (wdl == TB_LOSS)
 		return -1;
-	else if (wdl == TB_DRAW)
-		return 0;
-	else if (wdl == TB_CURSED_WIN || wdl == TB_WIN)
+	else if (wdl == TB_WIN)
 		return +1;
+	return 0;
 }
 
 int Tablebase::ProbeDTZ(Engine* engine) const
 {
-    std::string fen = engine->GetFEN();
-    struct pos pos0;
-    struct pos* pos = &pos0;
-    if (!parse_FEN(pos, fen.c_str()))
-        return false;
-
-	unsigned result = tb_probe_root(
-		pos->white,
-		pos->black,
-		pos->kings,
-		pos->queens,
-		pos->rooks,
-		pos->bishops,
-		pos->knights,
-		pos->pawns,
-		pos->rule50,
-		pos->castling,
-		pos->ep,
-		pos->turn,
-		NULL
-	);
+	unsigned result = ProbeRoot(engine);
+	if (result == TB_RESULT_FAILED)
+		return -99;
 
     int dtz = TB_GET_DTZ(result);
 
@@ -330,40 +220,59 @@ int Tablebase::ProbeDTZ(Engine* engine) const
 
 Move Tablebase::GetMove(Engine* engine) const
 {
-    std::string fen = engine->GetFEN();
-    struct pos pos0;
-    struct pos* pos = &pos0;
-    if (!parse_FEN(pos, fen.c_str()))
-        return false;
-
-    // TB_GET_FROM, TB_GET_TO, TB_GET_PROMOTES, TB_GET_EP
-    unsigned result = tb_probe_root(
-        pos->white,
-        pos->black,
-        pos->kings,
-        pos->queens,
-        pos->rooks,
-        pos->bishops,
-        pos->knights,
-        pos->pawns,
-        pos->rule50,
-        pos->castling,
-        pos->ep,
-        pos->turn,
-        NULL
-    );
-
-    int from = TB_GET_FROM(result);
-    int to = TB_GET_TO(result);
-    int promo = TB_GET_PROMOTES(result);
-    int ep = TB_GET_EP(result);
-
-    int parsedPromo = (int)Pieces::NONE;
-	if (promo == TB_PROMOTES_QUEEN) parsedPromo = (int)Pieces::QUEEN;
-	else if (promo == TB_PROMOTES_ROOK) parsedPromo = (int)Pieces::ROOK;
-	else if (promo == TB_PROMOTES_BISHOP) parsedPromo = (int)Pieces::BISHOP;
-	else if (promo == TB_PROMOTES_KNIGHT) parsedPromo = (int)Pieces::KNIGHT;
-
-    Move m = EncodeMove(flipSquareVertical(from), flipSquareVertical(to), parsedPromo, false, false);
-    return m;
+	unsigned result = ProbeRoot(engine);
+	if (result == TB_RESULT_FAILED || result == TB_RESULT_CHECKMATE || result == TB_RESULT_STALEMATE)
+		return Move();
+
+	std::vector<Move> legal;
+	GenerateLegal(engine, legal);
+	return FindMove(result, legal);
 }
+
+bool Tablebase::FilterRootMoves(Engine* engine, std::vector<Move>& moves) const
+{
+	if (!Probeable(engine->GetBitboardBoard()))
+		return false;
+
+	static thread_local unsigned results[TB_MAX_MOVES];
+	unsigned result = ProbeRoot(engine, results);
+	if (result == TB_RESULT_FAILED || result == TB_RESULT_CHECKMATE || result == TB_RESULT_STALEMATE)
+		return false;
+
+	// Per move WDL already counts the 50 move rule (a win that takes too long is cursed)
+	struct Ranked { Move move; unsigned wdl; unsigned dtz; };
+	std::vector<Ranked> ranked;
+	unsigned bestWDL = TB_LOSS;
+	for (int i = 0; results[i] != TB_RESULT_FAILED; ++i)
+	{
+		Move m = FindMove(results[i], moves);
+		if (MoveIsNull(m)) continue;
+
+		unsigned wdl = TB_GET_WDL(results[i]);
+		ranked.push_back({ m, wdl, TB_GET_DTZ(results[i]) });
+		bestWDL = std::max(bestWDL, wdl);
+	}
+	if (ranked.empty())
+		return false;
+
+	ranked.erase(std::remove_if(ranked.begin(), ranked.end(), [&](const Ranked& r) { return r.wdl != bestWDL; }), ranked.end());
+
+	// Winning: fastest to zero first so the 50 move counter never runs out. Losing: make it take as long as possible
+	bool winning = bestWDL == TB_WIN || bestWDL == TB_CURSED_WIN;
+	std::stable_sort(ranked.begin(), ranked.end(), [&](const Ranked& a, const Ranked& b) {
+		return winning ? a.dtz < b.dtz : a.dtz > b.dtz;
+	});
+
+	moves.clear();
+	for (const Ranked& r : ranked)
+		moves.push_back(r.move);
+	return true;
+}
+
+Tablebase& GetTablebase()
+{
+	static Tablebase tb("res/syzygy/");
+	return tb;
+}
+
+#endif // CHESS_NO_TABLEBASE
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "core/engine.hpp"
 
@@ -16,7 +17,12 @@ public:
 	// If the position can be probed (<= 7 pieces)
 	bool Probeable(const BitboardBoard& board) const;
 
+	// Probeable inside the search, also respects probeDepth and probeLimit
+	bool SearchProbeable(const BitboardBoard& board, int depth) const;
+
 	// Returns +1 for win for stm, 0 draw, -1 loss, -99 on error
+	// Cheap WDL probe for interior nodes, assumes the 50 move counter was just reset.
+	// Cursed wins/blessed losses count as draws since the 50 move rule gets there first
 	int ProbeWDL(Engine* engine) const;
 
 	// Returns distance to zeroing (>= 1) or -99 on unavailable
@@ -25,8 +31,18 @@ public:
 	// Get's best move
 	Move GetMove(Engine* engine) const;
 
+	// Cuts the legal root moves down to the ones that keep the best result (with the 50 move counter),
+	// quickest zeroing first when winning. False and moves untouched if the root couldn't be probed
+	bool FilterRootMoves(Engine* engine, std::vector<Move>& moves) const;
+
+	int probeDepth = 1; // Remaining depth needed before Search probes
+	int probeLimit = 7; // Max pieces (kings included) Search probes with
+
 private:
 	// Uses Fathom
 	// https://github.com/jdart1/Fathom.git
 	bool ok;
-};
\ No newline at end of file
+};
+
+// Shared prober, loads res/syzygy/ on first use
+Tablebase& GetTablebase();
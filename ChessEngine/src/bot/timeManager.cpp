@@ -0,0 +1,102 @@
+#include "timeManager.hpp"
+
+#include <algorithm>
+#include <limits>
+
+#include "core/boardCalculator.hpp"
+
+using namespace std::chrono;
+
+void TimeManager::Init(const SearchLimits& limits, Color us)
+{
+	startTime = steady_clock::now();
+	lastBestMove = 0;
+	lastScore = 0;
+	stableIterations = 0;
+
+	const long long overhead = std::max(0, limits.moveOverhead);
+	const int c = IsWhite(us) ? 0 : 1;
+
+	if (limits.infinite)
+	{
+		fixedTime = true;
+		softLimit = hardLimit = std::numeric_limits<long long>::max() / 4;
+	}
+	else if (limits.moveTime > 0)
+	{
+		fixedTime = true;
+		softLimit = hardLimit = std::max(1LL, limits.moveTime - overhead);
+	}
+	else if (limits.time[c] > 0)
+	{
+		fixedTime = false;
+
+		long long available = std::max(1LL, limits.time[c] - overhead);
+		int movesLeft = limits.movesToGo > 0 ? std::min(limits.movesToGo, 40) : 40; // Estimate if unknown
+
+		// Soft limit is what we aim for, most of the increment can be spent since it comes back
+		long long soft = available / movesLeft + (long long)limits.inc[c] * 3 / 4;
+
+		// Hard limit gives room for unstable positions, but never more than a chunk of the clock
+		// If the time control ends next move we can use most of what's left
+		long long hardCap = (limits.movesToGo == 1) ? available * 3 / 4 : available / 4;
+		long long hard = std::min(soft * 4, hardCap);
+
+		hardLimit = std::max(1LL, hard);
+		softLimit = std::max(1LL, std::min(soft, hardLimit));
+	}
+	else if (limits.depth > 0 || limits.nodes > 0)
+	{
+		// Depth/node limited searches are only stopped by their own limit so they're reproducible
+		fixedTime = true;
+		softLimit = hardLimit = std::numeric_limits<long long>::max() / 4;
+	}
+	else
+	{
+		// No valid timing info (e.g. analysis mode)
+		fixedTime = true;
+		softLimit = hardLimit = std::max(1LL, 1000 - overhead); // default 1 second
+	}
+}
+
+bool TimeManager::StopAfterIteration(int depth, Move bestMove, int score)
+{
+	if (fixedTime)
+		return HardLimitReached();
+
+	if (bestMove == lastBestMove) ++stableIterations;
+	else stableIterations = 0;
+
+	double scale = 1.0;
+
+	// Best move keeps flipping, spend more. Stable for a while, stop early
+	if (depth > 1)
+	{
+		if (stableIterations == 0)      scale = 1.4;
+		else if (stableIterations == 1) scale = 1.0;
+		else if (stableIterations == 2) scale = 0.85;
+		else if (stableIterations <= 4) scale = 0.7;
+		else                            scale = 0.5;
+
+		// Score fell since the last iteration, probably found a problem so look deeper
+		int drop = lastScore - score;
+		if (drop > 25)
+			scale *= 1.0 + std::min(drop, 100) / 200.0;
+	}
+
+	lastBestMove = bestMove;
+	lastScore = score;
+
+	long long target = std::min(hardLimit, (long long)(softLimit * scale));
+	return Elapsed() >= target;
+}
+
+bool TimeManager::HardLimitReached() const
+{
+	return Elapsed() >= hardLimit;
+}
+
+long long TimeManager::Elapsed() const
+{
+	return duration_cast<milliseconds>(steady_clock::now() - startTime).count();
+}
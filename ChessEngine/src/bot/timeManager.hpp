@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "core/piece.hpp"
+#include "core/move.hpp"
+
+// Everything the search needs to know about how long it's allowed to think
+// -1 means "not given"
+struct SearchLimits
+{
+	int time[2] = { -1, -1 }; // Remaining clock in ms, [white, black]
+	int inc[2]  = { 0, 0 };   // Increment per move in ms
+	int movesToGo = -1;       // Moves until next time control
+	int moveTime = -1;        // Fixed time per move
+	bool infinite = false;
+
+	int depth = -1;           // Fixed depth, search stops after completing this iteration
+	long long nodes = -1;     // Node budget, search aborts once it's spent
+
+	int moveOverhead = 10;    // Lag/GUI buffer subtracted from every allocation
+
+	int multiPV = 1;          // Root moves to report a line for, best first
+	bool useBook = true;      // Off when every position should be searched (batch analysis)
+
+	const std::atomic<bool>* stop = nullptr; // Raised from another thread (UCI stop/quit) to end the search early
+};
+
+class TimeManager
+{
+public:
+	// Works out the soft and hard limits for this move and starts the clock
+	void Init(const SearchLimits& limits, Color us);
+
+	// Called after every completed iteration, returns true if another iteration isn't worth starting
+	bool StopAfterIteration(int depth, Move bestMove, int score);
+
+	// Checked inside the search, the hard limit is never crossed
+	bool HardLimitReached() const;
+
+	long long Elapsed() const;
+	long long SoftLimit() const { return softLimit; }
+	long long HardLimit() const { return hardLimit; }
+
+private:
+	std::chrono::time_point<std::chrono::steady_clock> startTime;
+
+	long long softLimit = 0; // Target time, scaled by stability before deciding to stop
+	long long hardLimit = 0; // Absolute max, search aborts mid iteration past this
+	bool fixedTime = false;  // movetime/infinite, don't scale anything
+
+	Move lastBestMove = 0;
+	int lastScore = 0;
+	int stableIterations = 0; // How many iterations in a row the best move hasn't changed
+};
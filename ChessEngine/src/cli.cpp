@@ -0,0 +1,226 @@
+#include "cli.hpp"
+
+#include "core/engine.hpp"
+#include "core/gameState.hpp"
+#include "bot/bot.hpp"
+
+#include "bench.hpp"
+#include "perft.hpp"
+#include "bookBuilder.hpp"
+#include "analysis.hpp"
+#include "selfplay.hpp"
+#include "trainingData.hpp"
+#include "tuner.hpp"
+
+#include <memory>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <cstdlib>
+
+static int RunBenchCommand(int argc, char* argv[])
+{
+    std::unique_ptr<Engine> engine = std::make_unique<Engine>();
+    if (argc > 2 && std::string(argv[2]) == "eval")
+    {
+        RunEvalBench(engine.get(), argc > 3 ? std::atoi(argv[3]) : 200000);
+        return 0;
+    }
+
+    std::unique_ptr<Bot> bot = std::make_unique<Bot>(engine.get(), Color::WHITE);
+    RunBench(engine.get(), bot.get(), argc > 2 ? std::atoi(argv[2]) : BENCH_DEFAULT_DEPTH);
+    return 0;
+}
+
+static int RunPerftCommand(int argc, char* argv[])
+{
+    PerftTable tt;
+
+    if (std::string(argv[2]) == "suite")
+    {
+        std::unique_ptr<Engine> engine = std::make_unique<Engine>();
+        return RunPerftSuite(engine.get(), argc > 3 ? std::atoi(argv[3]) : 5, &tt) ? 0 : 1;
+    }
+
+    int threads = 1;
+    bool split = false; // Split the second ply across threads as well as the root
+    std::string fen;
+    for (int i = 3; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "threads" && i + 1 < argc) threads = std::atoi(argv[++i]);
+        else if (arg == "split") split = true;
+        else fen += arg + " ";
+    }
+    if (fen.empty())
+        fen = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+    if (threads > 1)
+    {
+        PerftParallel(fen, std::atoi(argv[2]), threads, &tt, split);
+        return 0;
+    }
+
+    std::unique_ptr<Engine> engine = std::make_unique<Engine>(fen);
+    PerftDivide(engine.get(), std::atoi(argv[2]), &tt);
+    return 0;
+}
+
+static int RunBookCommand(int argc, char* argv[])
+{
+    BookBuildOptions options;
+    for (int i = 4; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        if (arg == "threads") options.threads = std::atoi(argv[i + 1]);
+        else if (arg == "plies") options.maxPly = std::atoi(argv[i + 1]);
+        else if (arg == "min") options.minGames = std::atoi(argv[i + 1]);
+        else if (arg == "memory") options.memoryMB = std::atoi(argv[i + 1]);
+    }
+    return BuildBookFromPGN(argv[2], argv[3], options) ? 0 : 1;
+}
+
+static int RunAnalyzeCommand(int argc, char* argv[])
+{
+    AnalysisOptions options;
+    std::string outPath;
+    for (int i = 3; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "json") options.json = true;
+        else if (arg == "csv") options.json = false;
+        else if (i + 1 >= argc) break;
+        else if (arg == "depth") options.depth = std::atoi(argv[++i]);
+        else if (arg == "movetime") options.moveTime = std::atoi(argv[++i]);
+        else if (arg == "nodes") options.nodes = std::atoll(argv[++i]);
+        else if (arg == "threads") options.threads = std::atoi(argv[++i]);
+        else if (arg == "hash") options.hashMB = std::atoi(argv[++i]);
+        else if (arg == "out") outPath = argv[++i];
+    }
+
+    if (outPath.empty())
+        return RunAnalysis(argv[2], std::cout, options) ? 0 : 1;
+
+    std::ofstream out(outPath);
+    if (!out)
+    {
+        std::cerr << "Can't write " << outPath << '\n';
+        return 1;
+    }
+    return RunAnalysis(argv[2], out, options) ? 0 : 1;
+}
+
+static int RunSelfPlayCommand(int argc, char* argv[])
+{
+    SelfPlayOptions options;
+    for (int i = 2; i + 1 < argc; i += 2)
+    {
+        std::string arg = argv[i];
+        const char* value = argv[i + 1];
+        if (arg == "games") options.games = std::atoi(value);
+        else if (arg == "threads") options.threads = std::atoi(value);
+        else if (arg == "depth") options.depth = std::atoi(value);
+        else if (arg == "movetime") options.moveTime = std::atoi(value);
+        else if (arg == "nodes") options.nodes = std::atoll(value);
+        else if (arg == "hash") options.hashMB = std::atoi(value);
+        else if (arg == "openings") options.openingsEPD = value;
+        else if (arg == "bookfile") options.bookFile = value;
+        else if (arg == "book") options.bookPlies = std::atoi(value);
+        else if (arg == "random") options.randomPlies = std::atoi(value);
+        else if (arg == "resignscore") options.resignScore = std::atoi(value);
+        else if (arg == "resignmoves") options.resignMoves = std::atoi(value);
+        else if (arg == "drawscore") options.drawScore = std::atoi(value);
+        else if (arg == "drawmoves") options.drawMoves = std::atoi(value);
+        else if (arg == "drawply") options.drawMinPly = std::atoi(value);
+        else if (arg == "maxplies") options.maxPlies = std::atoi(value);
+        else if (arg == "pgn") options.pgnPath = value;
+        else if (arg == "data") options.dataPath = value;
+        else if (arg == "seed") options.seed = std::strtoull(value, nullptr, 10);
+    }
+    return RunSelfPlay(options) ? 0 : 1;
+}
+
+static int RunConvertCommand(int argc, char* argv[])
+{
+    std::string cmd = argv[1];
+    if (argc < 4)
+    {
+        if (cmd == "epd2bin")
+            std::cerr << "usage: " << argv[0] << " epd2bin <labeled.epd> <out.bin>\n";
+        else
+            std::cerr << "usage: " << argv[0] << " bin2epd <data.bin> <out.epd>\n";
+        return 1;
+    }
+    if (cmd == "epd2bin")
+        return ConvertEPDToTraining(argv[2], argv[3]) ? 0 : 1;
+    return ConvertTrainingToEPD(argv[2], argv[3]) ? 0 : 1;
+}
+
+static int RunTuneCommand(int argc, char* argv[])
+{
+    TunerOptions options;
+    for (int i = 3; i < argc; ++i)
+    {
+        std::string arg = argv[i];
+        if (arg == "nomaterial") options.tuneMaterial = false;
+        else if (i + 1 >= argc) break;
+        else if (arg == "threads") options.threads = std::atoi(argv[++i]);
+        else if (arg == "epochs") options.epochs = std::atoi(argv[++i]);
+        else if (arg == "batch") options.batchSize = std::atoi(argv[++i]);
+        else if (arg == "rate") options.learningRate = std::atof(argv[++i]);
+        else if (arg == "k") options.k = std::atof(argv[++i]);
+        else if (arg == "lambda") options.lambda = std::atof(argv[++i]);
+        else if (arg == "report") options.reportEvery = std::atoi(argv[++i]);
+        else if (arg == "out") options.outPath = argv[++i];
+    }
+    return RunTuner(argv[2], options) ? 0 : 1;
+}
+
+bool RunToolCommand(int argc, char* argv[], int& exitCode)
+{
+    if (argc < 2) return false;
+
+    std::string cmd = argv[1];
+    if (cmd == "bench")
+    {
+        GameState::uci = true; // No window
+        exitCode = RunBenchCommand(argc, argv);
+        return true;
+    }
+    if (cmd == "perft" && argc > 2)
+    {
+        GameState::uci = true;
+        exitCode = RunPerftCommand(argc, argv);
+        return true;
+    }
+    if (cmd == "analyze" && argc > 2)
+    {
+        GameState::uci = true;
+        exitCode = RunAnalyzeCommand(argc, argv);
+        return true;
+    }
+    if (cmd == "selfplay")
+    {
+        GameState::uci = true;
+        exitCode = RunSelfPlayCommand(argc, argv);
+        return true;
+    }
+    if (cmd == "book" && argc > 3)
+    {
+        GameState::uci = true;
+        exitCode = RunBookCommand(argc, argv);
+        return true;
+    }
+    if (cmd == "epd2bin" || cmd == "bin2epd")
+    {
+        exitCode = RunConvertCommand(argc, argv);
+        return true;
+    }
+    if (cmd == "tune" && argc > 2)
+    {
+        GameState::uci = true;
+        exitCode = RunTuneCommand(argc, argv);
+        return true;
+    }
+    return false;
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+// Command line tools that don't need a window, shared by the engine and the bench executable
+//   bench [depth]
+//   perft suite [maxDepth]
+//   perft <depth> [threads N] [split] [fen]
+// Returns false if argv isn't one of them, otherwise runs it and fills exitCode
+bool RunToolCommand(int argc, char* argv[], int& exitCode);
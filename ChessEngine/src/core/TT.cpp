@@ -1,10 +1,17 @@
 #include "TT.hpp"
 
+#include "bitops.hpp"
+
 void TranspositionTable::Clear()
 {
     for (auto& e : table) e.key = 0;
 }
 
+void TranspositionTable::ClearEvals()
+{
+    for (auto& e : table) e.staticEval = TT_NO_EVAL;
+}
+
 void TranspositionTable::NewSearch()
 {
     // increment age at each root search
@@ -24,9 +31,9 @@ TranspositionTable::TranspositionTable(int megabytes)
 {
     size_t bytes = megabytes * 1024ull * 1024ull;
     entries = bytes / sizeof(TTEntry);
-    unsigned long index;
     // round down to power of 2 for fast masking     what the fuck
-    if (_BitScanReverse64(&index, entries))
+    int index = LastMSBIndex(entries);
+    if (index >= 0)
     {
         size_t p2 = 1ull << index;
         entries = p2;
@@ -36,7 +43,21 @@ TranspositionTable::TranspositionTable(int megabytes)
     Clear();
 }
 
-bool TranspositionTable::ttProbe(uint64_t key, int depth, int alpha, int beta, int& outScore, uint32_t& outMove)
+static int ScoreToTT(int score, int ply)
+{
+    if (score >= TT_PLY_SCORE_BOUND) return score + ply;
+    if (score <= -TT_PLY_SCORE_BOUND) return score - ply;
+    return score;
+}
+
+static int ScoreFromTT(int score, int ply)
+{
+    if (score >= TT_PLY_SCORE_BOUND) return score - ply;
+    if (score <= -TT_PLY_SCORE_BOUND) return score + ply;
+    return score;
+}
+
+bool TranspositionTable::ttProbe(uint64_t key, int depth, int ply, int alpha, int beta, int& outScore, uint32_t& outMove)
 {
     size_t idx = IndexFor(key);
     TTEntry& e = table[idx];
@@ -45,19 +66,20 @@ bool TranspositionTable::ttProbe(uint64_t key, int depth, int alpha, int beta, i
         outMove = e.move32;
         if (e.depth >= depth)
         {
+            int score = ScoreFromTT(e.score, ply);
             if (e.flag == TT_EXACT)
             {
-                outScore = e.score;
+                outScore = score;
                 return true;
             }
-            else if (e.flag == TT_ALPHA && e.score <= alpha)
+            else if (e.flag == TT_ALPHA && score <= alpha)
             {
-                outScore = e.score;
+                outScore = score;
                 return true;
             }
-            else if (e.flag == TT_BETA && e.score >= beta)
+            else if (e.flag == TT_BETA && score >= beta)
             {
-                outScore = e.score;
+                outScore = score;
                 return true;
             }
         }
@@ -66,7 +88,7 @@ bool TranspositionTable::ttProbe(uint64_t key, int depth, int alpha, int beta, i
 }
 
 // store an entry
-void TranspositionTable::ttStore(uint64_t key, int depth, int score, uint32_t move32, uint8_t flag)
+void TranspositionTable::ttStore(uint64_t key, int depth, int ply, int score, uint32_t move32, uint8_t flag, int staticEval)
 {
     size_t idx = IndexFor(key);
     TTEntry& e = table[idx];
@@ -81,15 +103,35 @@ void TranspositionTable::ttStore(uint64_t key, int depth, int score, uint32_t mo
 
     if (replace)
     {
+        // Same position's eval doesn't change, keep it if this store doesn't have one
+        if (staticEval == TT_NO_EVAL && e.key == key) staticEval = e.staticEval;
+        else if (staticEval < INT16_MIN + 1 || staticEval > INT16_MAX) staticEval = TT_NO_EVAL;
+
         e.key = key;
+        e.staticEval = (int16_t)staticEval;
         e.depth = depth;
-        e.score = score;
+        e.score = ScoreToTT(score, ply);
         e.move32 = move32;
         e.flag = flag;
         e.age = currentAge;
     }
 }
 
+bool TranspositionTable::ttProbeEval(uint64_t key, int& outEval) const
+{
+    const TTEntry& e = table[IndexFor(key)];
+    if (e.key != key || e.staticEval == TT_NO_EVAL) return false;
+    outEval = e.staticEval;
+    return true;
+}
+
+void TranspositionTable::ttStoreEval(uint64_t key, int staticEval)
+{
+    TTEntry& e = table[IndexFor(key)];
+    if (e.key == key && staticEval > INT16_MIN && staticEval <= INT16_MAX)
+        e.staticEval = (int16_t)staticEval;
+}
+
 inline size_t TranspositionTable::IndexFor(uint64_t key) const
 {
     return (size_t)(key & (entries - 1));
@@ -7,11 +7,19 @@
 
 enum TTFlag : uint8_t { TT_UNKNOWN = 0, TT_EXACT = 1, TT_ALPHA = 2, TT_BETA = 3 };
 
+constexpr int TT_NO_EVAL = INT16_MIN; // staticEval of entries stored without one
+
+// Scores from here up (mates and tablebase wins, the bot's TB_WIN_IN_MAX_PLY) count plies from the root. The table
+// keeps them as the distance from the node instead, so they still mean the same thing when the position comes up
+// at another ply, and ttStore/ttProbe convert with the node's ply
+constexpr int TT_PLY_SCORE_BOUND = 1000000 - 3 * 128;
+
 struct TTEntry
 {
     uint64_t key;     // full zobrist key
     int32_t score;
     int16_t depth;    // ply or depth
+    int16_t staticEval; // Eval() for the side to move, TT_NO_EVAL if unknown (fits in the padding)
     uint32_t move32;  // encoded move (or index to Move pool); 0 = no move
     uint8_t flag;     // TTFlag
     uint8_t age;      // for simple replacement scheme
@@ -25,8 +33,11 @@ struct TranspositionTable
 
     TranspositionTable(int megabytes = 128);
 
-    bool ttProbe(uint64_t key, int depth, int alpha, int beta, int& outScore, uint32_t& outMove);
-    void ttStore(uint64_t key, int depth, int score, uint32_t move32, uint8_t flag);
+    bool ttProbe(uint64_t key, int depth, int ply, int alpha, int beta, int& outScore, uint32_t& outMove);
+    void ttStore(uint64_t key, int depth, int ply, int score, uint32_t move32, uint8_t flag, int staticEval = TT_NO_EVAL);
+    bool ttProbeEval(uint64_t key, int& outEval) const;
+    void ttStoreEval(uint64_t key, int staticEval); // Only fills in an existing entry for key, never replaces anything
+    void ClearEvals(); // Forget every staticEval but keep the search results
 
     inline size_t IndexFor(uint64_t key) const;
 
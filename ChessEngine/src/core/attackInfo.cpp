@@ -0,0 +1,103 @@
+#include "attackInfo.hpp"
+
+#include "movegen.hpp"
+
+constexpr Bitboard NOT_FILE_A = ~0x0101010101010101ULL;
+constexpr Bitboard NOT_FILE_H = ~0x8080808080808080ULL;
+
+// Pieces of either color that are the only thing between kingSq and a slider of sliderColor
+static Bitboard SliderBlockers(const BitboardBoard& board, int kingSq, int sliderColor)
+{
+	const Bitboard(&pieces)[6] = board.pieceBitboards[sliderColor];
+	Bitboard queens = pieces[(int)Pieces::QUEEN - 1];
+	Bitboard snipers = (Movegen::RookAttacks(kingSq, 0) & (pieces[(int)Pieces::ROOK - 1] | queens)) |
+		(Movegen::BishopAttacks(kingSq, 0) & (pieces[(int)Pieces::BISHOP - 1] | queens));
+
+	Bitboard blockers = 0;
+	while (snipers)
+	{
+		Bitboard between = Movegen::Between(kingSq, PopLSB(snipers)) & board.occupied;
+		if (between && !(between & (between - 1)))
+			blockers |= between;
+	}
+	return blockers;
+}
+
+void AttackInfo::Compute(const BitboardBoard& board, Color sideToMove)
+{
+	us = sideToMove == Color::WHITE ? 0 : 1;
+	int them = 1 - us;
+	Bitboard occ = board.occupied;
+
+	for (int c = 0; c < 2; ++c)
+	{
+		kingSq[c] = FirstLSBIndex(board.pieceBitboards[c][(int)Pieces::KING - 1]);
+		kingZone[c] = kingSq[c] >= 0 ? Movegen::GetKingAttacks()[kingSq[c]] | (1ULL << kingSq[c]) : 0;
+		kingZoneAttacks[c] = 0;
+	}
+
+	// Pawns all at once, white goes towards a8 (lower squares)
+	Bitboard whitePawns = board.pieceBitboards[0][(int)Pieces::PAWN - 1];
+	Bitboard blackPawns = board.pieceBitboards[1][(int)Pieces::PAWN - 1];
+	attackedBy[0][0] = ((whitePawns & NOT_FILE_A) >> 9) | ((whitePawns & NOT_FILE_H) >> 7);
+	attackedBy[1][0] = ((blackPawns & NOT_FILE_A) << 7) | ((blackPawns & NOT_FILE_H) << 9);
+
+	for (int c = 0; c < 2; ++c)
+	{
+		Bitboard safe = ~board.allPieces[c] & ~attackedBy[1 - c][0];
+		Bitboard enemyZone = kingZone[1 - c];
+
+		mobility[c][0] = 0;
+		kingZoneAttacks[1 - c] += PopCount64(attackedBy[c][0] & enemyZone);
+		attacked[c] = attackedBy[c][0];
+
+		for (int t = 1; t < 5; ++t)
+		{
+			Bitboard all = 0;
+			int count = 0;
+			Bitboard pieces = board.pieceBitboards[c][t];
+			while (pieces)
+			{
+				int sq = PopLSB(pieces);
+				Bitboard attacks;
+				switch (t + 1)
+				{
+				case (int)Pieces::KNIGHT: attacks = Movegen::GetKnightAttacks()[sq]; break;
+				case (int)Pieces::BISHOP: attacks = Movegen::BishopAttacks(sq, occ); break;
+				case (int)Pieces::ROOK:   attacks = Movegen::RookAttacks(sq, occ); break;
+				default:                  attacks = Movegen::BishopAttacks(sq, occ) | Movegen::RookAttacks(sq, occ); break;
+				}
+				all |= attacks;
+				count += PopCount64(attacks & safe);
+				kingZoneAttacks[1 - c] += PopCount64(attacks & enemyZone);
+			}
+			attackedBy[c][t] = all;
+			mobility[c][t] = count;
+			attacked[c] |= all;
+		}
+
+		attackedBy[c][5] = kingSq[c] >= 0 ? Movegen::GetKingAttacks()[kingSq[c]] : 0;
+		mobility[c][5] = 0;
+		attacked[c] |= attackedBy[c][5];
+	}
+
+	// Checks and pins, for both kings
+	checkers = kingSq[us] >= 0 ? Movegen::AttackersTo(kingSq[us], occ, board) & board.allPieces[them] : 0;
+	for (int c = 0; c < 2; ++c)
+		pinned[c] = kingSq[c] >= 0 ? SliderBlockers(board, kingSq[c], 1 - c) & board.allPieces[c] : 0;
+
+	int theirKing = kingSq[them];
+	if (theirKing < 0)
+	{
+		discoverers = 0;
+		for (Bitboard& squares : checkSquares) squares = 0;
+		return;
+	}
+	discoverers = SliderBlockers(board, theirKing, us) & board.allPieces[us];
+	checkSquares[0] = Movegen::GetPawnAttacks()[them][theirKing];
+	checkSquares[1] = Movegen::GetKnightAttacks()[theirKing];
+	checkSquares[2] = Movegen::BishopAttacks(theirKing, occ);
+	checkSquares[3] = Movegen::RookAttacks(theirKing, occ);
+	checkSquares[4] = checkSquares[2] | checkSquares[3];
+	checkSquares[5] = 0;
+}
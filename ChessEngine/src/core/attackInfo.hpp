@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+#include "piece.hpp"
+#include "bitboard.hpp"
+
+// Who attacks what in one position, worked out once with the slider lookups and then shared by whatever asks:
+// eval mobility and king safety, SEE, and the legality/check tests in movegen
+// Get it through Engine::GetAttackInfo, which computes it the first time it's needed at a ply
+struct AttackInfo
+{
+	uint64_t key = 0;               // Position it was computed for
+	int us = 0;                     // Side to move, 0 white 1 black
+	int kingSq[2] = { -1, -1 };
+
+	Bitboard attackedBy[2][6] = {}; // Per color and piece type (pawn first)
+	Bitboard attacked[2] = {};      // Everything each color attacks
+	Bitboard kingZone[2] = {};      // The king's square and the ring around it
+	int kingZoneAttacks[2] = {};    // Attacks on this color's king zone, one per enemy piece and square (pawns all together)
+	int mobility[2][6] = {};        // Attacked squares per piece type, minus own pieces and squares enemy pawns cover
+
+	Bitboard checkers = 0;          // Enemy pieces checking the side to move
+	Bitboard pinned[2] = {};        // Pieces that can only move along the line between their king and an enemy slider
+	Bitboard discoverers = 0;       // Side to move's pieces that give check by stepping off the line to the enemy king
+	Bitboard checkSquares[6] = {};  // Where a side to move piece of each type would check the enemy king
+
+	void Compute(const BitboardBoard& board, Color sideToMove);
+};
@@ -4,6 +4,7 @@
 #include <iostream>
 
 #include "piece.hpp"
+#include "bitops.hpp"
 
 using Bitboard = uint64_t;
 
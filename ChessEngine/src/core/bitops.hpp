@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstdint>
+
+// Portable bit tricks. MSVC gets its intrinsics, GCC/Clang get builtins which turn into
+// popcnt/tzcnt/pext when the target allows it (-mpopcnt, -mbmi2, -march=...)
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+#if defined(__BMI2__)
+#include <immintrin.h>
+#endif
+
+inline int PopCount64(uint64_t x)
+{
+#if defined(_MSC_VER)
+	return (int)__popcnt64(x);
+#else
+	return __builtin_popcountll(x);
+#endif
+}
+
+// Index of the lowest set bit, -1 if empty
+inline int FirstLSBIndex(uint64_t b)
+{
+	if (!b) return -1;
+#if defined(_MSC_VER)
+	unsigned long idx32 = 0;
+	_BitScanForward64(&idx32, b);
+	return static_cast<int>(idx32);
+#else
+	return __builtin_ctzll(b);
+#endif
+}
+
+// Index of the highest set bit, -1 if empty
+inline int LastMSBIndex(uint64_t b)
+{
+	if (!b) return -1;
+#if defined(_MSC_VER)
+	unsigned long idx32 = 0;
+	_BitScanReverse64(&idx32, b);
+	return static_cast<int>(idx32);
+#else
+	return 63 ^ __builtin_clzll(b);
+#endif
+}
+
+// Returns the lowest set bit and clears it, assumes b != 0
+inline int PopLSB(uint64_t& b)
+{
+#if defined(_MSC_VER)
+	unsigned long idx32 = 0;
+	_BitScanForward64(&idx32, b);    // idx32 will hold 0..63
+	b &= (b - 1);                    // clear LSB
+	return static_cast<int>(idx32);
+#else
+	int idx = __builtin_ctzll(b);    // count trailing zeros -> index of LSB
+	b &= (b - 1);
+	return idx;
+#endif
+}
+
+// Gathers the bits of x selected by mask into the low bits
+inline uint64_t Pext(uint64_t x, uint64_t mask)
+{
+#if defined(__BMI2__)
+	return _pext_u64(x, mask);
+#else
+	uint64_t result = 0;
+	for (uint64_t bit = 1; mask; bit <<= 1)
+	{
+		if (x & mask & (0 - mask)) // Lowest bit of mask
+			result |= bit;
+		mask &= mask - 1;
+	}
+	return result;
+#endif
+}
+
+// Reverses the byte order, for bitboards that's a vertical flip (rank 8 <-> rank 1)
+inline uint64_t FlipVertical(uint64_t x)
+{
+#if defined(_MSC_VER)
+	return _byteswap_uint64(x);
+#else
+	return __builtin_bswap64(x);
+#endif
+}
@@ -6,18 +6,6 @@
 #include "engine.hpp"
 #include "movegen.hpp"
 
-inline int FirstLSBIndex(Bitboard b)
-{
-	if (!b) return -1;
-#if defined(_MSC_VER)
-	unsigned long idx32 = 0;
-	_BitScanForward64(&idx32, b);
-	return static_cast<int>(idx32);
-#else
-	return __builtin_ctzll(b);
-#endif
-}
-
 bool BoardCalculator::GetPieceAt(int sq, const BitboardBoard& board, Piece& piece)
 {
 	if (!IdxInBounds(sq))
@@ -73,7 +61,7 @@ int BoardCalculator::TotalPieces(const BitboardBoard& board)
 	int total = 0;
 	for (int c = 0; c < 2; ++c)
 		for (int t = 0; t < 6; ++t)
-			total += __popcnt64(board.pieceBitboards[c][t]);
+			total += PopCount64(board.pieceBitboards[c][t]);
 	return total;
 }
 
@@ -0,0 +1,213 @@
+#include "cpu.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <process.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+#if defined(__APPLE__)
+#include <mach-o/dyld.h>
+#endif
+
+namespace
+{
+	struct Features
+	{
+		bool popcnt = false;
+		bool bmi2 = false;
+		bool fastPext = false; // Zen 1/2 do pext in microcode, it's slower than magics there
+		bool avx2 = false;
+		bool avx512 = false;   // F + BW
+	};
+
+#if defined(_MSC_VER) || defined(__x86_64__) || defined(__i386__)
+	void CpuId(int leaf, int sub, uint32_t out[4])
+	{
+#if defined(_MSC_VER)
+		int regs[4];
+		__cpuidex(regs, leaf, sub);
+		for (int i = 0; i < 4; ++i) out[i] = (uint32_t)regs[i];
+#else
+		__cpuid_count(leaf, sub, out[0], out[1], out[2], out[3]);
+#endif
+	}
+
+	// Which register states the OS saves on context switches
+	uint64_t XGetBv()
+	{
+#if defined(_MSC_VER)
+		return _xgetbv(0);
+#else
+		uint32_t eax, edx;
+		__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+		return ((uint64_t)edx << 32) | eax;
+#endif
+	}
+
+	Features Detect()
+	{
+		Features f;
+		uint32_t r[4]; // eax, ebx, ecx, edx
+
+		CpuId(0, 0, r);
+		const uint32_t maxLeaf = r[0];
+		const bool amd = r[1] == 0x68747541; // "Auth"enticAMD
+
+		CpuId(1, 0, r);
+		const uint32_t family = ((r[0] >> 8) & 0xF) + ((r[0] >> 20) & 0xFF);
+		f.popcnt = (r[2] >> 23) & 1;
+		const bool osxsave = (r[2] >> 27) & 1;
+		const bool avx = (r[2] >> 28) & 1;
+
+		const uint64_t xcr0 = osxsave ? XGetBv() : 0;
+		const bool osYmm = (xcr0 & 0x6) == 0x6;
+		const bool osZmm = (xcr0 & 0xE6) == 0xE6;
+
+		if (maxLeaf >= 7)
+		{
+			CpuId(7, 0, r);
+			const bool bmi1 = (r[1] >> 3) & 1;
+			f.bmi2 = bmi1 && ((r[1] >> 8) & 1);
+			f.avx2 = avx && osYmm && ((r[1] >> 5) & 1);
+			f.avx512 = f.avx2 && osZmm && ((r[1] >> 16) & 1) && ((r[1] >> 30) & 1);
+		}
+		f.fastPext = f.bmi2 && !(amd && family < 0x19);
+		return f;
+	}
+#else
+	Features Detect() { return Features(); }
+#endif
+
+	const Features& GetFeatures()
+	{
+		static const Features features = Detect();
+		return features;
+	}
+}
+
+const char* Cpu::Name(Flavor flavor)
+{
+	switch (flavor)
+	{
+	case Flavor::POPCNT: return "popcnt";
+	case Flavor::BMI2:   return "bmi2";
+	case Flavor::AVX2:   return "avx2";
+	case Flavor::AVX512: return "avx512";
+	default:             return "generic";
+	}
+}
+
+Cpu::Flavor Cpu::Compiled()
+{
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+	return Flavor::AVX512;
+#elif defined(__AVX2__) && defined(__BMI2__)
+	return Flavor::AVX2;
+#elif defined(__BMI2__)
+	return Flavor::BMI2;
+#elif defined(__POPCNT__)
+	return Flavor::POPCNT;
+#else
+	return Flavor::GENERIC;
+#endif
+}
+
+bool Cpu::Supported(Flavor flavor)
+{
+	const Features& f = GetFeatures();
+	switch (flavor)
+	{
+	case Flavor::GENERIC: return true;
+	case Flavor::POPCNT:  return f.popcnt;
+	case Flavor::BMI2:    return f.popcnt && f.fastPext;
+	case Flavor::AVX2:    return f.popcnt && f.fastPext && f.avx2;   // Built with bmi2 too, so they use pext sliders
+	case Flavor::AVX512:  return f.popcnt && f.fastPext && f.avx512;
+	default:              return false;
+	}
+}
+
+Cpu::Flavor Cpu::Best()
+{
+	for (int i = (int)Flavor::COUNT - 1; i > 0; --i)
+	{
+		if (Supported((Flavor)i))
+			return (Flavor)i;
+	}
+	return Flavor::GENERIC;
+}
+
+// Full path of the running binary, argv[0] can be a bare or relative name when started from PATH or a GUI
+static std::string ExecutablePath(const char* argv0)
+{
+#if defined(_WIN32)
+	char buffer[MAX_PATH];
+	DWORD length = GetModuleFileNameA(nullptr, buffer, MAX_PATH);
+	if (length > 0 && length < MAX_PATH) return std::string(buffer, length);
+#elif defined(__linux__)
+	char buffer[4096];
+	ssize_t length = readlink("/proc/self/exe", buffer, sizeof(buffer));
+	if (length > 0 && length < (ssize_t)sizeof(buffer)) return std::string(buffer, length);
+#elif defined(__APPLE__)
+	char buffer[4096];
+	uint32_t size = sizeof(buffer);
+	if (_NSGetExecutablePath(buffer, &size) == 0) return buffer;
+#endif
+	return argv0;
+}
+
+bool Cpu::DispatchToBestFlavor(int argc, char* argv[], [[maybe_unused]] int& exitCode)
+{
+	if (argc < 1 || argv[0] == nullptr) return false;
+
+	// Only the generic build hands over, so a flavor binary can never bounce back into another
+	if (Compiled() != Flavor::GENERIC) return false;
+
+	std::string self = ExecutablePath(argv[0]);
+#if defined(_WIN32)
+	std::string ext;
+	if (self.size() > 4 && _stricmp(self.c_str() + self.size() - 4, ".exe") == 0)
+		self.resize(self.size() - 4);
+	ext = ".exe";
+#else
+	const std::string ext;
+#endif
+
+	for (int i = (int)Best(); i > (int)Flavor::GENERIC; --i)
+	{
+		std::string path = self + "-" + Name((Flavor)i) + ext;
+		if (!std::ifstream(path).good())
+			continue;
+
+		std::vector<char*> args(argv, argv + argc);
+		args[0] = path.data();
+		args.push_back(nullptr);
+
+#if defined(_WIN32)
+		// No real exec on windows, wait on the child instead so the GUI keeps seeing this process
+		intptr_t result = _spawnv(_P_WAIT, path.c_str(), args.data());
+		if (result == -1) continue;
+		exitCode = (int)result;
+		return true;
+#else
+		execv(path.c_str(), args.data());
+		// Only gets here if exec failed, try the next one down
+#endif
+	}
+	return false;
+}
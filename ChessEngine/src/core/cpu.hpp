@@ -0,0 +1,30 @@
+#pragma once
+
+// Instruction set flavours the engine can be built for, each one includes the ones before it
+// The build picks one (CHESS_ARCH / CHESS_FLAVORS in CMake), the generic build can hand over to a faster one at startup
+namespace Cpu
+{
+	enum class Flavor
+	{
+		GENERIC, // Plain x86-64 (or whatever non x86 target)
+		POPCNT,
+		BMI2,    // + BMI/BMI2 (pext)
+		AVX2,
+		AVX512,
+		COUNT
+	};
+
+	const char* Name(Flavor flavor);
+
+	// What this binary was compiled for
+	Flavor Compiled();
+
+	// Best flavor this machine can run
+	Flavor Best();
+
+	bool Supported(Flavor flavor);
+
+	// If a faster build of this executable sits next to it (named <exe>-<flavor>) and the cpu supports it, runs that instead
+	// Returns false if nothing better was found, otherwise true with the child's exit code
+	bool DispatchToBestFlavor(int argc, char* argv[], int& exitCode);
+}
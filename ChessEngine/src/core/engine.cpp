@@ -2,7 +2,7 @@
 
 #include <iostream>
 #include <cmath>
-#include <Windows.h>
+#include <sstream>
 
 #include <cstdint>
 #include <algorithm>
@@ -38,8 +38,6 @@ void Engine::Init(std::string fen)
 	uint64_t startKey = GetZobristKey();
 	positionStack.push_back(startKey);
 	positionCounts[startKey] = 1;
-
-	Movegen::InitPrecomputedAttacks();
 }
 
 void Engine::Reset()
@@ -131,26 +129,26 @@ void Engine::Render()
 	// If first click is valid highlight the square
 	if (firstClick != -1)
 	{
-		graphics.QueueRender([=]() { graphics.DrawSquareHighlight(firstClick, { 0, 255, 0, 100 }); });
+		graphics.QueueRender([this]() { graphics.DrawSquareHighlight(firstClick, { 0, 255, 0, 100 }); });
 
 		// Render the valid moves for the selected piece
 		for (uint8_t moveSq : Movegen::GetValidMoves(firstClick, bitboards))
 		{
-			graphics.QueueRender([=]() { graphics.DrawSquareHighlight(moveSq, { 0, 0, 255, 100 }); }); // Blue highlight
+			graphics.QueueRender([this, moveSq]() { graphics.DrawSquareHighlight(moveSq, { 0, 0, 255, 100 }); }); // Blue highlight
 		}
 	}
 	// Highlight king if in check
 	if (checkStatus)
 	{
 		int kingPos = (checkStatus & 0b10) ? whiteKingPos : blackKingPos;
-		graphics.QueueRender([=]() { graphics.DrawSquareHighlight(kingPos, { 255, 0, 0, 100 }); }); // Red highlight
+		graphics.QueueRender([this, kingPos]() { graphics.DrawSquareHighlight(kingPos, { 255, 0, 0, 100 }); }); // Red highlight
 	}
 
 	if (moveHistory.size() >= 1)
 	{
 		Move lastMove = moveHistory.back();
-		graphics.QueueRender([=]() { graphics.DrawSquareHighlight(GetStart(lastMove), { 180, 255, 0, 100 }); });
-		graphics.QueueRender([=]() { graphics.DrawSquareHighlight(GetEnd(lastMove),   { 255, 180, 0, 100 }); });
+		graphics.QueueRender([this, lastMove]() { graphics.DrawSquareHighlight(GetStart(lastMove), { 180, 255, 0, 100 }); });
+		graphics.QueueRender([this, lastMove]() { graphics.DrawSquareHighlight(GetEnd(lastMove),   { 255, 180, 0, 100 }); });
 	}
 	
 	graphics.Render(board);
@@ -251,9 +249,7 @@ uint64_t Engine::ComputeFullHash() const
 		if (piece.GetType() != Pieces::NONE)
 		{
 			int idx = PieceToIndex(piece);  // Polyglot piece index 0..11
-			int polyglotSq = (7 - ToRow(sq)) * 8 + ToCol(sq);
-			hash ^= zobrist.piece[idx][polyglotSq];
-			//hash ^= zobrist.piece[idx][sq];
+			hash ^= zobrist.piece[idx][sq]; // Keys are already laid out by engine square, see zobrist.hpp
 		}
 	}
 
@@ -267,9 +263,8 @@ uint64_t Engine::ComputeFullHash() const
 	if (blackCastlingRights[0]) hash ^= zobrist.castling[3]; // BQ
 
 	// En passant (only the file)
-	if (enPassantTarget != -1)
+	if (EnPassantHashed())
 	{
-		//std::cout << "Adding en passant\n";
 		int file = ToCol(enPassantTarget);
 		hash ^= zobrist.enPassantFile[file];
 	}
@@ -277,6 +272,16 @@ uint64_t Engine::ComputeFullHash() const
 	return hash;
 }
 
+bool Engine::EnPassantHashed() const
+{
+	if (enPassantTarget == -1) return false;
+
+	// Polyglot only counts the ep square if the side to move has a pawn that could take,
+	// those pawns sit where an enemy pawn on the ep square would attack
+	int us = IsWhite(currentPlayer) ? 0 : 1;
+	return (Movegen::GetPawnAttacks()[1 - us][enPassantTarget] & bitboards.pieceBitboards[us][(int)Pieces::PAWN - 1]) != 0;
+}
+
 bool Engine::StoreMove(Move& move)
 {
 	int click = graphics.GetInputs();
@@ -413,7 +418,7 @@ void Engine::MakeMove(const Move move)
 	AppendUndoList(state, move);
 
 	// XOR OUT old state
-	if (enPassantTarget != -1)
+	if (EnPassantHashed())
 		zobristKey ^= zobrist.enPassantFile[ToCol(enPassantTarget)];
 
 	if (whiteCastlingRights[1]) zobristKey ^= zobrist.castling[0];
@@ -500,9 +505,9 @@ void Engine::MakeMove(const Move move)
 	// 6. Update halfmove clock etc.
 	if (movingPiece.GetType() == Pieces::PAWN || targetPiece.GetType() != Pieces::NONE)
 		halfmoves = 0;
-	else if (currentPlayer == Color::BLACK)
+	else
 		halfmoves++;
-	if (halfmoves >= 50) draw = true;
+	if (halfmoves >= 100) draw = true; // 50 moves each
 
 	// 7. Save moveHistory (you already do)
 	moveHistory.push_back(move);
@@ -522,14 +527,13 @@ void Engine::MakeMove(const Move move)
 	if (blackCastlingRights[1]) zobristKey ^= zobrist.castling[2];
 	if (blackCastlingRights[0]) zobristKey ^= zobrist.castling[3];
 
-	// XOR in new en-passant if present
-	if (enPassantTarget != -1)
-		zobristKey ^= zobrist.enPassantFile[ToCol(enPassantTarget)];
-
 	// --- Finally, flip side-to-move in engine state and in the hash consistently ---
 	ChangePlayers(); // Flips currentPlayer
-	if (IsWhite(currentPlayer))
-		zobristKey ^= zobrist.sideToMove;
+	zobristKey ^= zobrist.sideToMove; // Key holds it while white is to move, so it flips every move
+
+	// XOR in new en-passant if present, after the flip since it depends on who can take
+	if (EnPassantHashed())
+		zobristKey ^= zobrist.enPassantFile[ToCol(enPassantTarget)];
 
 	// Update check
 	CheckKingInCheck();
@@ -538,6 +542,22 @@ void Engine::MakeMove(const Move move)
 	positionCounts[zobristKey] += 1;
 }
 
+const AttackInfo& Engine::GetAttackInfo() const
+{
+	size_t ply = undoHistory.size();
+	while (attackInfos.size() <= ply)
+		attackInfos.emplace_back(); // A deque never moves what's already in it
+
+	// Same key is the same position, whatever was played before
+	AttackInfo& info = attackInfos[ply];
+	if (info.key != zobristKey || info.kingSq[0] == -1)
+	{
+		info.Compute(bitboards, GameState::currentPlayer);
+		info.key = zobristKey;
+	}
+	return info;
+}
+
 bool Engine::IsDraw() const
 {
 	if (draw) return true;
@@ -560,7 +580,7 @@ bool Engine::HasRepeated() const
 
 bool Engine::Is50Move() const
 {
-	return (halfmoves >= 50);
+	return (halfmoves >= 100);
 }
 
 bool Engine::ValidMove(const Piece piece, const Move move)
@@ -645,7 +665,7 @@ std::string Engine::GetFEN() const
 
 	fen += std::to_string(halfmoves); // Halfmove clock
 	fen += " ";
-	fen += std::to_string(moveHistory.size() / 2 + 1); // Fullmove number
+	fen += std::to_string(GetGamePly() / 2 + 1); // Fullmove number
 
 	return fen;
 }
@@ -710,13 +730,14 @@ void Engine::LoadPosition(std::string fen)
 	moveHistory.clear();
 	undoHistory.clear();
 	if (enPassant != "-")
-		enPassantTarget = ToIndex(ToRow(7 - (enPassant[1] - '0')), ToCol(enPassant[0] - 'a'));
+		enPassantTarget = ToIndex('8' - enPassant[1], enPassant[0] - 'a'); // Row 0 is rank 8
 	else
 		enPassantTarget = -1;
 
 	// 5 & 6. Halfmove and fullmove counters
 	halfmoves = std::stoi(halfmoveStr);
 	int fullmoves = std::stoi(fullmoveStr);
+	startPly = std::max(0, (fullmoves - 1) * 2) + (currentPlayer == Color::BLACK ? 1 : 0);
 
 	zobristKey = ComputeFullHash();
 	CheckKingInCheck();
@@ -864,7 +885,7 @@ void Engine::MakeNullMove()
 	AppendUndoList(state, Move());
 
 	// Clear en passant and castling
-	if (enPassantTarget != -1)
+	if (EnPassantHashed())
 		zobristKey ^= zobrist.enPassantFile[ToCol(enPassantTarget)];
 	if (whiteCastlingRights[1]) zobristKey ^= zobrist.castling[0];
 	if (whiteCastlingRights[0]) zobristKey ^= zobrist.castling[1];
@@ -874,11 +895,10 @@ void Engine::MakeNullMove()
 
 	halfmoves++;
 
-	if (halfmoves >= 50) { draw = true; }
+	if (halfmoves >= 100) { draw = true; }
 
 	ChangePlayers();
-	if (IsWhite(currentPlayer))
-		zobristKey ^= zobrist.sideToMove;
+	zobristKey ^= zobrist.sideToMove;
 
 	if (whiteCastlingRights[1]) zobristKey ^= zobrist.castling[0];
 	if (whiteCastlingRights[0]) zobristKey ^= zobrist.castling[1];
@@ -2,6 +2,7 @@
 
 #include <unordered_map>
 #include <vector>
+#include <deque>
 #include <string>
 
 #include "piece.hpp"
@@ -13,6 +14,7 @@
 
 #include "graphics/graphicsEngine.hpp"
 #include "bitboard.hpp"
+#include "attackInfo.hpp"
 
 class Bot;
 
@@ -44,7 +46,17 @@ public:
 	const Color GetCurrentPlayer() const { return GameState::currentPlayer; }
 	const uint64_t GetZobristKey() { return zobristKey; }
 	std::string GetFEN() const; // Get current position in FEN notation
-	uint64_t ComputeFullHash() const;
+	const AttackInfo& GetAttackInfo() const; // Attack maps of the current position, computed on the first call at each ply
+	uint64_t ComputeFullHash() const; // Polyglot key from scratch, the incremental zobristKey always matches it
+	int GetPly() const { return (int)moveHistory.size(); } // Plies played since the position was set
+	int GetGamePly() const { return startPly + GetPly(); } // Plies since the start of the game, from the FEN's fullmove number
+	// Last move was a capture or pawn move (reset the 50 move counter), false after a null move
+	bool LastMoveZeroing() const
+	{
+		if (undoHistory.size() <= 1) return false; // Only the initial position
+		const BoardState& last = undoHistory.back();
+		return last.movedPiece == (uint8_t)Pieces::PAWN || last.capturedPiece != (uint8_t)Pieces::NONE;
+	}
 
 	bool IsDraw() const;
 	bool IsThreefold() const;
@@ -58,10 +70,6 @@ public:
 	int PieceToIndex(const Piece& p) const;
 	bool ValidMove(const Piece piece, const Move move); // Checks if the move is valid for the piece
 
-	float kingSafetyWeight = 0.25;
-	float pieceActivityWeight = 1.0;//0.35;
-	float materialWeight = 1.0;//0.40;
-
 private:
 	bool StoreMove(Move& move);   // Returns if there was a second click to make a move
 	void ProcessMove(Move& move); // Validates move
@@ -70,6 +78,7 @@ private:
 	void UpdateCastlingRights(const Move move, const Piece movingPiece, const Piece targetPiece);
 	void UpdateEnPassantSquare(const Move move);
 	void AppendUndoList(BoardState state, const Move move);
+	bool EnPassantHashed() const; // If the ep file is part of the key
 
 	inline void ChangePlayers() { GameState::currentPlayer = Opponent(GameState::currentPlayer); }
 
@@ -78,7 +87,7 @@ private:
 
 	BitboardBoard bitboards;
 
-	Zobrist zobrist;
+	static constexpr const Zobrist& zobrist = zobristKeys; // Shared by every engine, see zobrist.hpp
 	uint64_t zobristKey = 0;
 
 	// For 3 move rep
@@ -87,8 +96,10 @@ private:
 
 	std::vector<Move> moveHistory;
 	std::vector<BoardState> undoHistory;
+	mutable std::deque<AttackInfo> attackInfos; // One per undoHistory depth, so a node's stays put while its children are searched
 
 	int firstClick;			  // Not static variable for rendering purposes
+	int startPly = 0;         // Game ply of the loaded position
 	int whiteKingPos = -1;
 	int blackKingPos = -1;
 
@@ -6,98 +6,124 @@
 #include <cmath>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
+#include <iomanip>
 
 #include "movegen.hpp"
 #include "boardCalculator.hpp"
 #include "constants.hpp"
 #include "engine.hpp"
 
-#include <intrin.h>
-#  define __builtin_popcount __popcnt
-
-// Pawns
-int pawnPST[64] = {
-	 0,  0,  0,  0,  0,  0,  0,  0,
-	50, 50, 50, 50, 50, 50, 50, 50,
-	10, 10, 20, 30, 30, 20, 10, 10,
-	 5,  5, 10, 25, 25, 10,  5,  5,
-	 0,  0,  0, 20, 20,  0,  0,  0,
-	 5, -5,-10,  0,  0,-10, -5,  5,
-	 5, 10, 10,-20,-20, 10, 10,  5,
-	 0,  0,  0,  0,  0,  0,  0,  0
-};
-
-// King, middle game
-int kingPST_mg[64] = {
-   -30,-40,-40,-50,-50,-40,-40,-30,
-   -30,-40,-40,-50,-50,-40,-40,-30,
-   -30,-40,-40,-50,-50,-40,-40,-30,
-   -30,-40,-40,-50,-50,-40,-40,-30,
-   -20,-30,-30,-40,-40,-30,-30,-20,
-   -10,-20,-20,-20,-20,-20,-20,-10,
-	20, 20,  0,  0,  0,  0, 20, 20,
-	20, 30, 10,  0,  0, 10, 30, 20
-};
-
-// King, endgame
-int kingPST_eg[64] = {
-   -50,-40,-30,-20,-20,-30,-40,-50,
-   -30,-20,-10,  0,  0,-10,-20,-30,
-   -30,-10, 20, 30, 30, 20,-10,-30,
-   -30,-10, 30, 40, 40, 30,-10,-30,
-   -30,-10, 30, 40, 40, 30,-10,-30,
-   -30,-10, 20, 30, 30, 20,-10,-30,
-   -30,-30,  0,  0,  0,  0,-30,-30,
-   -50,-30,-30,-30,-30,-30,-30,-50
-};
 
-// Knight PST
-int knightPST[64] = {
-   -50,-40,-30,-30,-30,-30,-40,-50,
-   -40,-20,  0,  0,  0,  0,-20,-40,
-   -30,  0, 10, 15, 15, 10,  0,-30,
-   -30,  5, 15, 20, 20, 15,  5,-30,
-   -30,  0, 15, 20, 20, 15,  0,-30,
-   -30,  5, 10, 15, 15, 10,  5,-30,
-   -40,-20,  0,  5,  5,  0,-20,-40,
-   -50,-40,-30,-30,-30,-30,-40,-50
-};
+// Hand picked, PSTs are from white's side (a8 first) and black looks them up on the mirrored square
+constexpr EvalWeights DEFAULT_EVAL_WEIGHTS = {
+	{ 0, 100, 320, 330, 500, 900, 100000 },
 
-// Bishop PST
-int bishopPST[64] = {
-   -20,-10,-10,-10,-10,-10,-10,-20,
-   -10,  0,  0,  0,  0,  0,  0,-10,
-   -10,  0,  5, 10, 10,  5,  0,-10,
-   -10,  5,  5, 10, 10,  5,  5,-10,
-   -10,  0, 10, 10, 10, 10,  0,-10,
-   -10, 10, 10, 10, 10, 10, 10,-10,
-   -10,  5,  0,  0,  0,  0,  5,-10,
-   -20,-10,-10,-10,-10,-10,-10,-20
+	// Pawns
+	{
+		 0,  0,  0,  0,  0,  0,  0,  0,
+		50, 50, 50, 50, 50, 50, 50, 50,
+		10, 10, 20, 30, 30, 20, 10, 10,
+		 5,  5, 10, 25, 25, 10,  5,  5,
+		 0,  0,  0, 20, 20,  0,  0,  0,
+		 5, -5,-10,  0,  0,-10, -5,  5,
+		 5, 10, 10,-20,-20, 10, 10,  5,
+		 0,  0,  0,  0,  0,  0,  0,  0
+	},
+
+	// Knights
+	{
+	   -50,-40,-30,-30,-30,-30,-40,-50,
+	   -40,-20,  0,  0,  0,  0,-20,-40,
+	   -30,  0, 10, 15, 15, 10,  0,-30,
+	   -30,  5, 15, 20, 20, 15,  5,-30,
+	   -30,  0, 15, 20, 20, 15,  0,-30,
+	   -30,  5, 10, 15, 15, 10,  5,-30,
+	   -40,-20,  0,  5,  5,  0,-20,-40,
+	   -50,-40,-30,-30,-30,-30,-40,-50
+	},
+
+	// Bishops
+	{
+	   -20,-10,-10,-10,-10,-10,-10,-20,
+	   -10,  0,  0,  0,  0,  0,  0,-10,
+	   -10,  0,  5, 10, 10,  5,  0,-10,
+	   -10,  5,  5, 10, 10,  5,  5,-10,
+	   -10,  0, 10, 10, 10, 10,  0,-10,
+	   -10, 10, 10, 10, 10, 10, 10,-10,
+	   -10,  5,  0,  0,  0,  0,  5,-10,
+	   -20,-10,-10,-10,-10,-10,-10,-20
+	},
+
+	// Rooks
+	{
+		 0,  0,  0,  5,  5,  0,  0,  0,
+		-5,  0,  0,  0,  0,  0,  0, -5,
+		-5,  0,  0,  0,  0,  0,  0, -5,
+		-5,  0,  0,  0,  0,  0,  0, -5,
+		-5,  0,  0,  0,  0,  0,  0, -5,
+		-5,  0,  0,  0,  0,  0,  0, -5,
+		 5, 10, 10, 10, 10, 10, 10,  5,
+		 0,  0,  0,  0,  0,  0,  0,  0
+	},
+
+	// Queens
+	{
+	   -20,-10,-10, -5, -5,-10,-10,-20,
+	   -10,  0,  0,  0,  0,  0,  0,-10,
+	   -10,  0,  5,  5,  5,  5,  0,-10,
+		-5,  0,  5,  5,  5,  5,  0, -5,
+		 0,  0,  5,  5,  5,  5,  0, -5,
+	   -10,  5,  5,  5,  5,  5,  0,-10,
+	   -10,  0,  5,  0,  0,  0,  0,-10,
+	   -20,-10,-10, -5, -5,-10,-10,-20
+	},
+
+	// King, middle game
+	{
+	   -30,-40,-40,-50,-50,-40,-40,-30,
+	   -30,-40,-40,-50,-50,-40,-40,-30,
+	   -30,-40,-40,-50,-50,-40,-40,-30,
+	   -30,-40,-40,-50,-50,-40,-40,-30,
+	   -20,-30,-30,-40,-40,-30,-30,-20,
+	   -10,-20,-20,-20,-20,-20,-20,-10,
+		20, 20,  0,  0,  0,  0, 20, 20,
+		20, 30, 10,  0,  0, 10, 30, 20
+	},
+
+	// King, endgame
+	{
+	   -50,-40,-30,-20,-20,-30,-40,-50,
+	   -30,-20,-10,  0,  0,-10,-20,-30,
+	   -30,-10, 20, 30, 30, 20,-10,-30,
+	   -30,-10, 30, 40, 40, 30,-10,-30,
+	   -30,-10, 30, 40, 40, 30,-10,-30,
+	   -30,-10, 20, 30, 30, 20,-10,-30,
+	   -30,-30,  0,  0,  0,  0,-30,-30,
+	   -50,-30,-30,-30,-30,-30,-30,-50
+	},
+
+	15, // doubledPenalty
+	20, // isolatedPenalty
+	20, // passedBonus
+	30, // bishopPair, per bishop
+	25, // rookOpenFile
+	15, // rookSemiOpenFile
+	25, // rookSameFile, per rook
+	30, // rookSeventh
+
+	4, // knightMobility
+	4, // bishopMobility
+	2, // rookMobility
+	1, // queenMobility
+	5, // kingZoneAttack
 };
 
-// Rook PST
-int rookPST[64] = {
-	 0,  0,  0,  5,  5,  0,  0,  0,
-	-5,  0,  0,  0,  0,  0,  0, -5,
-	-5,  0,  0,  0,  0,  0,  0, -5,
-	-5,  0,  0,  0,  0,  0,  0, -5,
-	-5,  0,  0,  0,  0,  0,  0, -5,
-	-5,  0,  0,  0,  0,  0,  0, -5,
-	 5, 10, 10, 10, 10, 10, 10,  5,
-	 0,  0,  0,  0,  0,  0,  0,  0
-};
+// Default scale, nothing to fold at startup
+EvalWeights evalWeights = DEFAULT_EVAL_WEIGHTS;
 
-// Queen PST
-int queenPST[64] = {
-   -20,-10,-10, -5, -5,-10,-10,-20,
-   -10,  0,  0,  0,  0,  0,  0,-10,
-   -10,  0,  5,  5,  5,  5,  0,-10,
-	-5,  0,  5,  5,  5,  5,  0, -5,
-	 0,  0,  5,  5,  5,  5,  0, -5,
-   -10,  5,  5,  5,  5,  5,  0,-10,
-   -10,  0,  5,  0,  0,  0,  0,-10,
-   -20,-10,-10, -5, -5,-10,-10,-20
-};
+static float materialScale = 1.0f;
+static float activityScale = 1.0f;
 
 int Mirror(int sq)
 {
@@ -131,239 +157,258 @@ const Bitboard RANK_MASK[8] = {
 	0x00000000000000FFULL  // Rank 1
 };
 
-int Eval(Color player, const Engine* engine)
+void SetEvalScale(float material, float activity)
+{
+	materialScale = material;
+	activityScale = activity;
+
+	const int* from = reinterpret_cast<const int*>(&DEFAULT_EVAL_WEIGHTS);
+	int* to = reinterpret_cast<int*>(&evalWeights);
+	for (int i = 0; i < EVAL_WEIGHT_COUNT; ++i)
+	{
+		bool isMaterial = i < (int)(sizeof(EvalWeights::pieceValues) / sizeof(int)); // pieceValues come first
+		to[i] = (int)std::lround(from[i] * (isMaterial ? material : activity));
+	}
+}
+
+// TRACE writes every term down, the search's Eval is the instantiation without it
+template<bool TRACE>
+static int EvalWhite(const Engine* engine, EvalTrace* trace)
 {
 	const BitboardBoard& board = engine->GetBitboardBoard();
+	const EvalWeights& w = evalWeights;
 
 	int kingSafetyScore = 0;
 	int pieceActivityScore = 0;
 	int materialScore = 0;
 
-	const int pieceValues[] = { 0, 100, 320, 330, 500, 900, 100000 };
-
-	Bitboard whiteOcc = board.allPieces[0];
-	Bitboard blackOcc = board.allPieces[1];
-	Bitboard allOcc = whiteOcc | blackOcc;
-
-	// Pawn structure masks
-	const int doubledPenalty = 15;
-	const int isolatedPenalty = 20;
-	const int backwardPenalty = 20;
-	const int passedBonus = 20;
-	const int islandPenalty = 10;
-	const int connectedPawnBonus = 15;
-	const int advancedPawnBonus = 10; // every pawn pass rank 5
-
-	// Mobility scaling
-	//const int mobilityBonus = 5; // per legal square
+	// Weight added (sign 1) or taken (-1) for color, as a white side score. Counted terms pass the count as sign
+	auto term = [&](EvalTerm evalTerm, const int& weight, int color, int sign)
+	{
+		if constexpr (TRACE)
+		{
+			trace->terms[evalTerm][color] += weight * sign;
+			trace->coefficients[&weight - reinterpret_cast<const int*>(&w)] += color == 0 ? sign : -sign;
+		}
+		return color == 0 ? weight * sign : -weight * sign;
+	};
 
-	// TODO: Make this more cache friendly, like sq on the inside loop
-	for (int sq = 0; sq < 64; ++sq)
+	// Occupied squares only, piece type by piece type
+	for (int color = 0; color < 2; ++color)
 	{
-		for (int color = 0; color < 2; ++color)
+		for (int t = 0; t < 6; ++t)
 		{
-			for (int t = 0; t < 6; ++t)
+			Bitboard pieces = board.pieceBitboards[color][t];
+			while (pieces)
 			{
-				if (IsSet(board.pieceBitboards[color][t], sq))
+				int sq = PopLSB(pieces);
+				Pieces type = static_cast<Pieces>(t + 1);
+				bool isWhite = (color == 0);
+				int pstSq = isWhite ? sq : Mirror(sq);
+
+				materialScore += term(EVAL_MATERIAL, w.pieceValues[t + 1], color, 1);
+
+				switch (type)
 				{
-					Pieces type = static_cast<Pieces>(t + 1);
-					bool isWhite = (color == 0);
-					int value = pieceValues[t + 1];
-					int mirroredSq = Mirror(sq);
+				case Pieces::PAWN:
+				{
+					pieceActivityScore += term(EVAL_PAWN_PST, w.pawnPST[pstSq], color, 1);
+
+					int col = ToCol(sq);
+					int row = ToRow(sq);
+					Bitboard fileMask = FILE_MASK[col];
+					Bitboard leftMask = (col > 0) ? FILE_MASK[col - 1] : 0ULL;
+					Bitboard rightMask = (col < 7) ? FILE_MASK[col + 1] : 0ULL;
+
+					Bitboard sameFile = board.pieceBitboards[color][(int)Pieces::PAWN - 1] & fileMask;
+					Bitboard adjFiles = board.pieceBitboards[color][(int)Pieces::PAWN - 1] & (leftMask | rightMask);
+					Bitboard enemyPawns = board.pieceBitboards[1 - color][(int)Pieces::PAWN - 1];
+
+					// Doubled pawns
+					if (PopCount64(sameFile) > 1)
+					{
+						pieceActivityScore += term(EVAL_DOUBLED, w.doubledPenalty, color, -1);
+					}
+
+					// Isolated pawns
+					if (adjFiles == 0ULL)
+					{
+						pieceActivityScore += term(EVAL_ISOLATED, w.isolatedPenalty, color, -1);
+					}
 
+					// Passed pawns
+					Bitboard blockingPawns = enemyPawns & (fileMask | leftMask | rightMask);
+					Bitboard inFrontEnemyPawns = 0ULL;
 					if (isWhite)
-						materialScore += value;
+					{
+						for (int r = row - 1; r >= 0; --r)
+							inFrontEnemyPawns |= (1ULL << ToIndex(r, col));
+					}
 					else
-						materialScore -= value;
-
-					switch (type)
 					{
-					case Pieces::PAWN:
+						for (int r = row + 1; r < 8; ++r)
+							inFrontEnemyPawns |= (1ULL << ToIndex(r, col));
+					}
+					if ((blockingPawns & inFrontEnemyPawns) == 0ULL)
 					{
-						if (isWhite) pieceActivityScore += pawnPST[sq];
-						else         pieceActivityScore -= pawnPST[mirroredSq];
-
-						int col = ToCol(sq);
-						int row = ToRow(sq);
-						Bitboard fileMask = FILE_MASK[col];
-						Bitboard leftMask = (col > 0) ? FILE_MASK[col - 1] : 0ULL;
-						Bitboard rightMask = (col < 7) ? FILE_MASK[col + 1] : 0ULL;
-
-						Bitboard sameFile = board.pieceBitboards[color][(int)Pieces::PAWN - 1] & fileMask;
-						Bitboard adjFiles = board.pieceBitboards[color][(int)Pieces::PAWN - 1] & (leftMask | rightMask);
-						Bitboard enemyPawns = board.pieceBitboards[1 - color][(int)Pieces::PAWN - 1];
-
-						// Doubled pawns
-						if (__builtin_popcount(sameFile) > 1)
-						{
-							pieceActivityScore += isWhite ? -doubledPenalty : doubledPenalty;
-						}
-
-						// Isolated pawns
-						if (adjFiles == 0ULL)
-						{
-							pieceActivityScore += isWhite ? -isolatedPenalty : isolatedPenalty;
-						}
-
-						// Passed pawns
-						Bitboard blockingPawns = enemyPawns & (fileMask | leftMask | rightMask);
-						Bitboard inFrontEnemyPawns = 0ULL;
-						if (isWhite)
-						{
-							for (int r = row - 1; r >= 0; --r)
-								inFrontEnemyPawns |= (1ULL << ToIndex(r, col));
-						}
-						else
-						{
-							for (int r = row + 1; r < 8; ++r)
-								inFrontEnemyPawns |= (1ULL << ToIndex(r, col));
-						}
-						if ((blockingPawns & inFrontEnemyPawns) == 0ULL)
-						{
-							// base bonus, +10 if rank 5, +25 if rank 6, and +60 if rank 7
-							//int rankBonus = 0;
-							//if (isWhite)
-							//{
-							//	if (row == 3) rankBonus = 10;
-							//	else if (row == 2) rankBonus = 25;
-							//	else if (row == 1) rankBonus = 60;
-							//}
-							//else
-							//{
-							//	if (row == 4) rankBonus = 10;
-							//	else if (row == 5) rankBonus = 25;
-							//	else if (row == 6) rankBonus = 60;
-							//}
-
-							pieceActivityScore += isWhite ? passedBonus : -(passedBonus);
-						}
-
-						break;
+						// base bonus, +10 if rank 5, +25 if rank 6, and +60 if rank 7
+						//int rankBonus = 0;
+						//if (isWhite)
+						//{
+						//	if (row == 3) rankBonus = 10;
+						//	else if (row == 2) rankBonus = 25;
+						//	else if (row == 1) rankBonus = 60;
+						//}
+						//else
+						//{
+						//	if (row == 4) rankBonus = 10;
+						//	else if (row == 5) rankBonus = 25;
+						//	else if (row == 6) rankBonus = 60;
+						//}
+
+						pieceActivityScore += term(EVAL_PASSED, w.passedBonus, color, 1);
 					}
-					case Pieces::KNIGHT:
+
+					break;
+				}
+				case Pieces::KNIGHT:
+				{
+					pieceActivityScore += term(EVAL_KNIGHT_PST, w.knightPST[pstSq], color, 1);
+					break;
+				}
+				case Pieces::BISHOP:
+				{
+					pieceActivityScore += term(EVAL_BISHOP_PST, w.bishopPST[pstSq], color, 1);
+
+					// Bonus if both colors of bishop are present
+					Bitboard bishops = board.pieceBitboards[color][(int)Pieces::BISHOP - 1];
+					Bitboard lightSquares = 0x55AA55AA55AA55AAULL; // Light square mask
+					Bitboard darkSquares = 0xAA55AA55AA55AA55ULL;  // Dark square mask
+					if ((bishops & lightSquares) && (bishops & darkSquares))
 					{
-						if (isWhite) pieceActivityScore += knightPST[sq];
-						else         pieceActivityScore -= knightPST[Mirror(sq)];
-
-						//Bitboard attacks = Movegen::GetPseudoAttacks(type, sq, allOcc, isWhite);
-						//attacks &= ~((isWhite) ? whiteOcc : blackOcc);
-						//int mobility = __builtin_popcount(attacks);
-						//score += isWhite ? mobility * mobilityBonus : -mobility * mobilityBonus;
-						break;
+						pieceActivityScore += term(EVAL_BISHOP_PAIR, w.bishopPair, color, 1);
 					}
-					case Pieces::BISHOP:
+					// -5 for every friendly pawn on the same color square as the bishop
+					//Bitboard pawns = board.pieceBitboards[color][(int)Pieces::PAWN - 1];
+					//Bitboard sameColorPawns = (IsSet(lightSquares, sq)) ? (pawns & lightSquares) : (pawns & darkSquares);
+					//int numSameColorPawns = PopCount64(sameColorPawns);
+					//score += isWhite ? -5 * numSameColorPawns : 5 * numSameColorPawns;
+					break;
+				}
+				case Pieces::ROOK:
+				{
+					pieceActivityScore += term(EVAL_ROOK_PST, w.rookPST[pstSq], color, 1);
+
+					// Open file, or semi-open file
+					int col = ToCol(sq);
+					Bitboard fileMask = FILE_MASK[col];
+					Bitboard friendlyPawns = board.pieceBitboards[color][(int)Pieces::PAWN - 1];
+					Bitboard enemyPawns = board.pieceBitboards[1 - color][(int)Pieces::PAWN - 1];
+					if ((friendlyPawns & fileMask) == 0ULL && (enemyPawns & fileMask) == 0ULL)
 					{
-						if (isWhite) pieceActivityScore += bishopPST[sq];
-						else         pieceActivityScore -= bishopPST[Mirror(sq)];
-
-						// +30 if both colors of bishop are present
-						Bitboard bishops = board.pieceBitboards[color][(int)Pieces::BISHOP - 1];
-						Bitboard lightSquares = 0x55AA55AA55AA55AAULL; // Light square mask
-						Bitboard darkSquares = 0xAA55AA55AA55AA55ULL;  // Dark square mask
-						if ((bishops & lightSquares) && (bishops & darkSquares))
-						{
-							pieceActivityScore += isWhite ? 30 : -30;
-						}
-						// -5 for every friendly pawn on the same color square as the bishop
-						//Bitboard pawns = board.pieceBitboards[color][(int)Pieces::PAWN - 1];
-						//Bitboard sameColorPawns = (IsSet(lightSquares, sq)) ? (pawns & lightSquares) : (pawns & darkSquares);
-						//int numSameColorPawns = __builtin_popcount(sameColorPawns);
-						//score += isWhite ? -5 * numSameColorPawns : 5 * numSameColorPawns;
-
-						//Bitboard attacks = Movegen::GetPseudoAttacks(type, sq, allOcc, isWhite);
-						//attacks &= ~((isWhite) ? whiteOcc : blackOcc);
-						//int mobility = __builtin_popcount(attacks);
-						//score += isWhite ? mobility * mobilityBonus : -mobility * mobilityBonus;
-						break;
+						pieceActivityScore += term(EVAL_ROOK_FILE, w.rookOpenFile, color, 1);
 					}
-					case Pieces::ROOK:
+					else if ((friendlyPawns & fileMask) == 0ULL)
 					{
-						if (isWhite) pieceActivityScore += rookPST[sq];
-						else         pieceActivityScore -= rookPST[Mirror(sq)];
-
-						// +25 if on open file, +15 if on semi-open file
-						int col = ToCol(sq);
-						Bitboard fileMask = FILE_MASK[col];
-						Bitboard friendlyPawns = board.pieceBitboards[color][(int)Pieces::PAWN - 1];
-						Bitboard enemyPawns = board.pieceBitboards[1 - color][(int)Pieces::PAWN - 1];
-						if ((friendlyPawns & fileMask) == 0ULL && (enemyPawns & fileMask) == 0ULL)
-						{
-							pieceActivityScore += isWhite ? 25 : -25;
-						}
-						else if ((friendlyPawns & fileMask) == 0ULL)
-						{
-							pieceActivityScore += isWhite ? 15 : -15;
-						}
-
-						// +25 if on same file as other rook
-						Bitboard rooks = board.pieceBitboards[color][(int)Pieces::ROOK - 1];
-						if (__builtin_popcount(rooks & fileMask) > 1)
-						{
-							pieceActivityScore += isWhite ? 25 : -25;
-						}
-
-						// +30 if on 7th rank
-						int row = ToRow(sq);
-						if ((isWhite && row == 1) || (!isWhite && row == 6))
-						{
-							pieceActivityScore += isWhite ? 30 : -30;
-						}
-
-						//Bitboard attacks = Movegen::GetPseudoAttacks(type, sq, allOcc, isWhite);
-						//attacks &= ~((isWhite) ? whiteOcc : blackOcc);
-						//int mobility = __builtin_popcount(attacks);
-						//score += isWhite ? mobility * mobilityBonus : -mobility * mobilityBonus;
-						break;
+						pieceActivityScore += term(EVAL_ROOK_FILE, w.rookSemiOpenFile, color, 1);
 					}
-					case Pieces::QUEEN:
+
+					// On the same file as the other rook
+					Bitboard rooks = board.pieceBitboards[color][(int)Pieces::ROOK - 1];
+					if (PopCount64(rooks & fileMask) > 1)
 					{
-						if (isWhite) pieceActivityScore += queenPST[sq];
-						else         pieceActivityScore -= queenPST[Mirror(sq)];
-
-						//Bitboard attacks = Movegen::GetPseudoAttacks(type, sq, allOcc, isWhite);
-						//attacks &= ~((isWhite) ? whiteOcc : blackOcc);
-						//int mobility = __builtin_popcount(attacks);
-						//score += isWhite ? mobility * mobilityBonus : -mobility * mobilityBonus;
-						break;
+						pieceActivityScore += term(EVAL_ROOK_FILE, w.rookSameFile, color, 1);
 					}
 
-					//case Pieces::KNIGHT:
-					//	if (isWhite) score += knightPST[sq];
-					//	else         score -= knightPST[mirroredSq];
-					//	break;
-					//case Pieces::BISHOP:
-					//	if (isWhite) score += bishopPST[sq];
-					//	else         score -= bishopPST[mirroredSq];
-					//	break;
-					//case Pieces::ROOK:
-					//	if (isWhite) score += rookPST[sq];
-					//	else         score -= rookPST[mirroredSq];
-					//	break;
-					//case Pieces::QUEEN:
-					//	if (isWhite) score += queenPST[sq];
-					//	else         score -= queenPST[mirroredSq];
-					//	break;
-					case Pieces::KING:
-						if (!GameState::endgame)
-						{
-							if (isWhite) pieceActivityScore += kingPST_mg[sq];
-							else		 pieceActivityScore -= kingPST_mg[Mirror(sq)];
-						}
-						else
-						{
-							if (isWhite) pieceActivityScore += kingPST_eg[sq];
-							else		 pieceActivityScore -= kingPST_eg[Mirror(sq)];
-						}
-						break;
+					// On the 7th rank
+					int row = ToRow(sq);
+					if ((isWhite && row == 1) || (!isWhite && row == 6))
+					{
+						pieceActivityScore += term(EVAL_ROOK_SEVENTH, w.rookSeventh, color, 1);
 					}
+					break;
+				}
+				case Pieces::QUEEN:
+				{
+					pieceActivityScore += term(EVAL_QUEEN_PST, w.queenPST[pstSq], color, 1);
+					break;
+				}
+				case Pieces::KING:
+					if (!GameState::endgame)
+						pieceActivityScore += term(EVAL_KING_PST, w.kingPST_mg[pstSq], color, 1);
+					else
+						pieceActivityScore += term(EVAL_KING_PST, w.kingPST_eg[pstSq], color, 1);
+					break;
+				case Pieces::NONE:
+					break;
 				}
 			}
 		}
 	}
 
-	float score = ((float)materialScore * engine->materialWeight) + ((float)pieceActivityScore * engine->pieceActivityWeight);
+	// Mobility and king safety off the attack maps, which the search shares
+	const AttackInfo& attacks = engine->GetAttackInfo();
+	for (int color = 0; color < 2; ++color)
+	{
+		const int(&mobility)[6] = attacks.mobility[color];
+		pieceActivityScore += term(EVAL_MOBILITY, w.knightMobility, color, mobility[(int)Pieces::KNIGHT - 1]);
+		pieceActivityScore += term(EVAL_MOBILITY, w.bishopMobility, color, mobility[(int)Pieces::BISHOP - 1]);
+		pieceActivityScore += term(EVAL_MOBILITY, w.rookMobility, color, mobility[(int)Pieces::ROOK - 1]);
+		pieceActivityScore += term(EVAL_MOBILITY, w.queenMobility, color, mobility[(int)Pieces::QUEEN - 1]);
+		kingSafetyScore += term(EVAL_KING_SAFETY, w.kingZoneAttack, color, -attacks.kingZoneAttacks[color]);
+	}
+
+	// Scaling is already in the weights
+	int score = materialScore + pieceActivityScore + kingSafetyScore;
+
+	if constexpr (TRACE)
+	{
+		trace->material = materialScore;
+		trace->activity = pieceActivityScore + kingSafetyScore;
+		trace->materialScale = materialScale;
+		trace->activityScale = activityScale;
+		trace->score = score;
+	}
+
+	return score;
+}
+
+int Eval(Color player, const Engine* engine)
+{
+	int score = EvalWhite<false>(engine, nullptr);
+	return player == Color::BLACK ? -score : score;
+}
+
+int EvalWithTrace(const Engine* engine, EvalTrace& trace)
+{
+	trace = EvalTrace();
+	return EvalWhite<true>(engine, &trace);
+}
+
+const char* EvalTermName(EvalTerm term)
+{
+	static const char* names[EVAL_TERM_COUNT] = {
+		"Material", "Pawn PST", "Knight PST", "Bishop PST", "Rook PST", "Queen PST", "King PST",
+		"Doubled pawns", "Isolated pawns", "Passed pawns", "Bishop pair", "Rook files", "Rook 7th",
+		"Mobility", "King safety"
+	};
+	return names[term];
+}
+
+std::string EvalTraceToString(const EvalTrace& trace)
+{
+	std::ostringstream out;
+	auto row = [&](const std::string& name, int white, int black)
+	{
+		out << std::left << std::setw(16) << name << std::right << std::setw(9) << white << std::setw(9) << black << std::setw(9) << white - black << '\n';
+	};
 
-	if (player == Color::BLACK) score *= -1;
+	out << std::left << std::setw(16) << "Term" << std::right << std::setw(9) << "White" << std::setw(9) << "Black" << std::setw(9) << "Total" << '\n';
+	for (int t = 0; t < EVAL_TERM_COUNT; ++t)
+		row(EvalTermName((EvalTerm)t), trace.terms[t][0], trace.terms[t][1]);
 
-	return (int)score;
+	out << '\n';
+	out << "Material " << trace.material << " (scale " << trace.materialScale << "), activity " << trace.activity << " (scale " << trace.activityScale << ")\n";
+	out << "Final evaluation " << trace.score << " (white side)\n";
+	return out.str();
 }
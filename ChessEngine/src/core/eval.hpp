@@ -1,18 +1,91 @@
 #pragma once
 
 #include "engine.hpp"
-#include "gamestate.hpp"
+#include "gameState.hpp"
 #include "square.hpp"
 
-extern int pawnPST_white[64];
-extern int pawnPST_black[64];
-extern int kingPST_mg_white[64];
-extern int kingPST_mg_black[64];
-extern int kingPST_eg_white[64];
-extern int kingPST_eg_black[64];
-extern int knightPST[64];
-extern int bishopPST[64];
-extern int rookPST[64];
-extern int queenPST[64];
-
-int Eval(Color player, const Engine* engine);
\ No newline at end of file
+#include <string>
+#include <type_traits>
+
+// Every number Eval() uses, in one place so the tuner can treat them as one flat int array
+// PSTs are from white's side (a8 first), black uses the mirrored square
+struct EvalWeights
+{
+	int pieceValues[7]; // Indexed by Pieces, the king's value just cancels out
+	int pawnPST[64];
+	int knightPST[64];
+	int bishopPST[64];
+	int rookPST[64];
+	int queenPST[64];
+	int kingPST_mg[64];
+	int kingPST_eg[64];
+
+	int doubledPenalty;   // Per pawn with another one on its file
+	int isolatedPenalty;
+	int passedBonus;
+	int bishopPair;       // Per bishop when both colors are there
+	int rookOpenFile;
+	int rookSemiOpenFile;
+	int rookSameFile;     // Per rook sharing its file with the other one
+	int rookSeventh;
+
+	int knightMobility;   // Per square a piece attacks that isn't taken by its own side or covered by enemy pawns
+	int bishopMobility;
+	int rookMobility;
+	int queenMobility;
+	int kingZoneAttack;   // Per attack on the squares around the king (penalty)
+};
+
+constexpr int EVAL_WEIGHT_COUNT = sizeof(EvalWeights) / sizeof(int);
+static_assert(sizeof(EvalWeights) == EVAL_WEIGHT_COUNT * sizeof(int), "EvalWeights must be nothing but ints");
+static_assert(std::is_standard_layout<EvalWeights>::value, "EvalWeights is read as a flat int array");
+
+// What Eval uses: the defaults (DEFAULT_EVAL_WEIGHTS in eval.cpp) with the scale folded in
+extern EvalWeights evalWeights;
+
+// Scales the material and the activity half of the eval. Folded into evalWeights here, once, so Eval only ever adds
+// ints (rounded per weight). Not safe while a search is running
+void SetEvalScale(float material, float activity);
+
+enum EvalTerm
+{
+	EVAL_MATERIAL,
+	EVAL_PAWN_PST,
+	EVAL_KNIGHT_PST,
+	EVAL_BISHOP_PST,
+	EVAL_ROOK_PST,
+	EVAL_QUEEN_PST,
+	EVAL_KING_PST,
+	EVAL_DOUBLED,
+	EVAL_ISOLATED,
+	EVAL_PASSED,
+	EVAL_BISHOP_PAIR,
+	EVAL_ROOK_FILE,
+	EVAL_ROOK_SEVENTH,
+	EVAL_MOBILITY,
+	EVAL_KING_SAFETY,
+	EVAL_TERM_COUNT
+};
+
+// Everything that went into one eval
+struct EvalTrace
+{
+	int terms[EVAL_TERM_COUNT][2] = {};       // Per color from its own side, penalties are negative
+	int coefficients[EVAL_WEIGHT_COUNT] = {}; // How often each weight was used, white minus black (what the tuner needs)
+	int material = 0;                         // White side sums, already scaled
+	int activity = 0;
+	float materialScale = 1;
+	float activityScale = 1;
+	int score = 0;                            // White side, same as Eval(WHITE)
+};
+
+int Eval(Color player, const Engine* engine);
+
+// Reference eval with every term written down, returns the white side score
+// Its own instantiation of the eval, Eval() doesn't carry any of the bookkeeping
+int EvalWithTrace(const Engine* engine, EvalTrace& trace);
+
+const char* EvalTermName(EvalTerm term);
+
+// Term table (white, black, total) plus the scaling, what the UCI eval command prints
+std::string EvalTraceToString(const EvalTrace& trace);
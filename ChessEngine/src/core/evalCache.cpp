@@ -0,0 +1,19 @@
+#include "evalCache.hpp"
+
+#include "bitops.hpp"
+
+EvalCache::EvalCache(int kilobytes)
+{
+    size_t entries = kilobytes * 1024ull / sizeof(uint64_t);
+    int index = LastMSBIndex(entries);
+    entries = index > 0 ? 1ull << index : 1; // Power of two for masking
+    table = std::make_unique<std::atomic<uint64_t>[]>(entries);
+    mask = entries - 1;
+    Clear();
+}
+
+void EvalCache::Clear()
+{
+    for (size_t i = 0; i <= mask; ++i)
+        table[i].store(0, std::memory_order_relaxed);
+}
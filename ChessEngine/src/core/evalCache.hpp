@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <cstdint>
+
+// Small always-replace cache of static evals keyed by zobrist key
+// One 64 bit word per entry (upper 32 key bits + score), so it never needs a lock: a reader sees a whole
+// entry or a different key, never half of one. The lowest of those key bits is always set, so an empty
+// (all zero) slot can't pass for a key whose upper half is zero
+struct EvalCache
+{
+    EvalCache(int kilobytes = 1024);
+
+    bool Probe(uint64_t key, int& outScore) const
+    {
+        uint64_t entry = table[key & mask].load(std::memory_order_relaxed);
+        if ((entry ^ (key | TAG_BIT)) >> 32) return false;
+        outScore = (int32_t)(uint32_t)entry;
+        return true;
+    }
+
+    void Store(uint64_t key, int score)
+    {
+        table[key & mask].store(((key | TAG_BIT) & 0xFFFFFFFF00000000ull) | (uint32_t)score, std::memory_order_relaxed);
+    }
+
+    void Clear();
+
+private:
+    static constexpr uint64_t TAG_BIT = 1ull << 32;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> table;
+    size_t mask; // entries - 1, entries is a power of two
+};
@@ -1,5 +1,21 @@
 #include "gameState.hpp"
 
+void GameState::Reset()
+{
+	currentPlayer = Color::WHITE;
+	checkStatus = 0;
+	enPassantTarget = 0;
+	halfmoves = 0;
+	endgame = false;
+	checkmate = false;
+	draw = false;
+	invalidMove = false;
+	whiteCastlingRights[0] = true;
+	whiteCastlingRights[1] = true;
+	blackCastlingRights[0] = true;
+	blackCastlingRights[1] = true;
+}
+
 BoardState::BoardState()
 	: capturedPiece(0), movedPiece(0), promotion(0), fromSquare(0), toSquare(0),
 	enPassantTarget(64), castlingRights(0), halfmoveClock(0),
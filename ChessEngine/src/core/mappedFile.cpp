@@ -0,0 +1,105 @@
+#include "mappedFile.hpp"
+
+#include <fstream>
+
+#if defined(_WIN32)
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::string& path, Access access)
+{
+	Close();
+	if (path.empty()) return false;
+
+#if defined(_WIN32)
+	DWORD flags = (access == Access::SEQUENTIAL) ? FILE_FLAG_SEQUENTIAL_SCAN : FILE_FLAG_RANDOM_ACCESS;
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | flags, nullptr);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER fileSize;
+	if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0)
+	{
+		HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (mapping)
+		{
+			mapView = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+			if (mapView)
+			{
+				mapHandle = mapping;
+				fileHandle = file;
+				size = (size_t)fileSize.QuadPart;
+			}
+			else CloseHandle(mapping);
+		}
+	}
+	if (!mapView) CloseHandle(file);
+#else
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	if (fstat(fd, &st) == 0 && st.st_size > 0)
+	{
+		void* view = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (view != MAP_FAILED)
+		{
+			mapView = view;
+			size = (size_t)st.st_size;
+			madvise(view, size, access == Access::SEQUENTIAL ? MADV_SEQUENTIAL : MADV_RANDOM);
+		}
+	}
+	close(fd); // The mapping stays valid
+#endif
+
+	if (mapView)
+	{
+		data = static_cast<const uint8_t*>(mapView);
+		return true;
+	}
+
+	// Couldn't map it (odd filesystem), just read the whole thing in
+	std::ifstream file(path, std::ios::binary | std::ios::ate);
+	if (!file) return false;
+	std::streamsize fileSize = file.tellg();
+	if (fileSize <= 0) return false;
+	fallback.resize((size_t)fileSize);
+	file.seekg(0);
+	file.read(reinterpret_cast<char*>(fallback.data()), fileSize);
+	data = fallback.data();
+	size = fallback.size();
+	return true;
+}
+
+void MappedFile::Close()
+{
+#if defined(_WIN32)
+	if (mapView) UnmapViewOfFile(mapView);
+	if (mapHandle) CloseHandle(mapHandle);
+	if (fileHandle) CloseHandle(fileHandle);
+#else
+	if (mapView) munmap(mapView, size);
+#endif
+	mapView = nullptr;
+	mapHandle = nullptr;
+	fileHandle = nullptr;
+	fallback.clear();
+	fallback.shrink_to_fit();
+	data = nullptr;
+	size = 0;
+}
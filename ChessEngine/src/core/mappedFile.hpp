@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Read only view of a whole file. Memory mapped where possible (nothing is copied and every process
+// shares the pages), read into memory if mapping fails
+class MappedFile
+{
+public:
+	// Hint for the OS, binary searches don't want read ahead, streaming through wants lots of it
+	enum class Access { RANDOM, SEQUENTIAL };
+
+	MappedFile() = default;
+	~MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	// Closes whatever was open first, fails on missing or empty files
+	bool Open(const std::string& path, Access access = Access::RANDOM);
+	void Close();
+
+	bool IsOpen() const { return data != nullptr; }
+	const uint8_t* Data() const { return data; }
+	size_t Size() const { return size; }
+
+private:
+	const uint8_t* data = nullptr;
+	size_t size = 0;
+
+	// Mapping handles, or a plain copy of the file if mapping isn't possible
+	void* mapView = nullptr;
+	void* fileHandle = nullptr;
+	void* mapHandle = nullptr;
+	std::vector<uint8_t> fallback;
+};
@@ -2,73 +2,306 @@
 
 #include "boardCalculator.hpp"
 #include "engine.hpp"
+#include "attackInfo.hpp"
 
 #include <vector>
 #include <iostream>
+#include <algorithm>
+#include <array>
 
 #include "constants.hpp"
 
-inline int PopLSB(Bitboard& b)
+// Define offsets and directions
+const int Movegen::bishopDirs[4] = {
+	-9,   -7,
+
+	7,	   9
+};
+const int Movegen::rookDirs[4] = {
+		-8,
+	 -1,   1,
+		 8
+};
+const int Movegen::queenDirs[8] = {
+	-9, -8, -7,
+	-1,      1,
+	 7,  8,  9
+};
+
+// All the attack tables are built at compile time and live in read only data, nothing to set up at startup
+
+struct LeaperTables
+{
+	Bitboard pawn[2][64];
+	Bitboard knight[64];
+	Bitboard king[64];
+};
+
+static constexpr LeaperTables BuildLeaperTables()
+{
+	LeaperTables t{};
+	for (int sq = 0; sq < 64; ++sq)
+	{
+		int r = ToRow(sq);
+		int c = ToCol(sq);
+
+		// Knight moves
+		Bitboard mask = EMPTY_BITBOARD;
+
+		int dr[8] = { 2,  2, 1,  1, -1, -1, -2, -2 };
+		int dc[8] = { 1, -1, 2, -2,  2, -2,  1, -1 };
+
+		for (int i = 0; i < 8; ++i)
+		{
+			int nr = r + dr[i];
+			int nc = c + dc[i];
+
+			if (InBounds(nr, nc))
+				mask |= 1ULL << ToIndex(nr, nc);
+		}
+		t.knight[sq] = mask;
+
+		// King moves
+		mask = EMPTY_BITBOARD;
+		for (int dr = -1; dr <= 1; ++dr)
+		{
+			for (int dc = -1; dc <= 1; ++dc)
+			{
+				if (dr == 0 && dc == 0) continue;
+				int nr = r + dr;
+				int nc = c + dc;
+				if (InBounds(nr, nc))
+					mask |= 1ULL << ToIndex(nr, nc);
+			}
+		}
+		t.king[sq] = mask;
+
+		// Pawn attacks
+		// White pawns
+		mask = EMPTY_BITBOARD;
+		if (InBounds(r - 1, c - 1)) mask |= 1ULL << ToIndex(r - 1, c - 1);
+		if (InBounds(r - 1, c + 1)) mask |= 1ULL << ToIndex(r - 1, c + 1);
+		t.pawn[(int)Color::WHITE][sq] = mask;
+
+		mask = EMPTY_BITBOARD;
+		if (InBounds(r + 1, c - 1)) mask |= 1ULL << ToIndex(r + 1, c - 1);
+		if (InBounds(r + 1, c + 1)) mask |= 1ULL << ToIndex(r + 1, c + 1);
+		t.pawn[(int)Color::BLACK][sq] = mask;
+	}
+	return t;
+}
+
+static constexpr LeaperTables leapers = BuildLeaperTables();
+static constexpr const Bitboard (&pawnAttacks)[2][64] = leapers.pawn;
+static constexpr const Bitboard (&knightAttacks)[64] = leapers.knight;
+static constexpr const Bitboard (&kingAttacks)[64] = leapers.king;
+
+static constexpr Bitboard RookMask(int sq)
+{
+	Bitboard mask = 0ULL;
+	int rank = ToRow(sq);
+	int file = ToCol(sq);
+
+	// North
+	for (int r = rank + 1; r <= 6; r++) mask |= 1ULL << ToIndex(r, file);
+	// South
+	for (int r = rank - 1; r >= 1; r--) mask |= 1ULL << ToIndex(r, file);
+	// East
+	for (int f = file + 1; f <= 6; f++) mask |= 1ULL << ToIndex(rank, f);
+	// West
+	for (int f = file - 1; f >= 1; f--) mask |= 1ULL << ToIndex(rank, f);
+
+	return mask;
+}
+
+static constexpr Bitboard BishopMask(int sq)
+{
+	Bitboard mask = 0ULL;
+	int r = ToRow(sq), c = ToCol(sq);
+
+	const int dr[4] = { -1, -1, 1, 1 };
+	const int dc[4] = { -1, 1, -1, 1 };
+
+	for (int dir = 0; dir < 4; ++dir)
+	{
+		int tr = r + dr[dir];
+		int tc = c + dc[dir];
+		while (InBounds(tr, tc))
+		{
+			// Stop before the edge square
+			if (tr == 0 || tr == 7 || tc == 0 || tc == 7) break;
+			mask |= 1ULL << ToIndex(tr, tc);
+			tr += dr[dir];
+			tc += dc[dir];
+		}
+	}
+	return mask;
+}
+
+static constexpr Bitboard ComputeRookAttacks(int sq, Bitboard occ)
 {
-	// assumes b != 0
-#if defined(_MSC_VER)
-	unsigned long idx32 = 0;
-	_BitScanForward64(&idx32, b);    // idx32 will hold 0..63
-	b &= (b - 1);                    // clear LSB
-	return static_cast<int>(idx32);
+	Bitboard attacks = 0ULL;
+	int r = ToRow(sq), c = ToCol(sq);
+
+	const int dr[4] = { -1, 0, 0, 1 };
+	const int dc[4] = { 0, -1, 1, 0 };
+
+	for (int dir = 0; dir < 4; ++dir)
+	{
+		int tr = r + dr[dir];
+		int tc = c + dc[dir];
+		while (InBounds(tr, tc))
+		{
+			int t = ToIndex(tr, tc);
+			attacks |= (1ULL << t);
+			if (occ & (1ULL << t)) break; // Blocked
+			tr += dr[dir];
+			tc += dc[dir];
+		}
+	}
+	return attacks;
+}
+
+static constexpr Bitboard ComputeBishopAttacks(int sq, Bitboard occ)
+{
+	Bitboard attacks = 0ULL;
+	int r = ToRow(sq), c = ToCol(sq);
+
+	const int dr[4] = { -1, -1, 1, 1 };
+	const int dc[4] = { -1, 1, -1, 1 };
+
+	for (int dir = 0; dir < 4; ++dir)
+	{
+		int tr = r + dr[dir];
+		int tc = c + dc[dir];
+		while (InBounds(tr, tc))
+		{
+			int t = ToIndex(tr, tc);
+			attacks |= (1ULL << t);
+			if (occ & (1ULL << t)) break; // Blocked
+			tr += dr[dir];
+			tc += dc[dir];
+		}
+	}
+	return attacks;
+}
+
+// Every square only gets 2^(64 - shift) slots (2^relevant bits), packed back to back in one table
+// instead of 64 * (4096 + 512) fixed rows, so the whole thing is ~840KB rather than ~2.3MB
+static constexpr std::array<uint32_t, 65> SliceOffsets(const int (&shifts)[64], uint32_t start)
+{
+	std::array<uint32_t, 65> offsets{};
+	offsets[0] = start;
+	for (int sq = 0; sq < 64; ++sq)
+		offsets[sq + 1] = offsets[sq] + (1u << (64 - shifts[sq]));
+	return offsets;
+}
+
+static constexpr std::array<uint32_t, 65> rookOffsets = SliceOffsets(rookShifts, 0);
+static constexpr std::array<uint32_t, 65> bishopOffsets = SliceOffsets(bishopShifts, rookOffsets[64]);
+constexpr uint32_t SLIDER_TABLE_SIZE = bishopOffsets[64];
+static_assert(SLIDER_TABLE_SIZE == 102400 + 5248, "Shifts should be 64 - relevant bits");
+
+struct SliderTables
+{
+	Bitboard rookMasks[64];
+	Bitboard bishopMasks[64];
+	Bitboard attacks[SLIDER_TABLE_SIZE];
+};
+
+// Walks every subset of the mask (carry rippler), which goes in the same order as the pext index
+static constexpr void FillSlice(Bitboard* slice, int sq, Bitboard mask, [[maybe_unused]] uint64_t magic, [[maybe_unused]] int shift, Bitboard (*compute)(int, Bitboard))
+{
+#if defined(CHESS_PEXT_SLIDERS)
+	uint32_t n = 0;
+#endif
+	Bitboard occ = 0ULL;
+	do
+	{
+#if defined(CHESS_PEXT_SLIDERS)
+		uint32_t index = n++;
 #else
-	int idx = __builtin_ctzll(b);    // count trailing zeros -> index of LSB
-	b &= (b - 1);
-	return idx;
+		uint32_t index = (uint32_t)((occ * magic) >> shift);
 #endif
+		slice[index] = compute(sq, occ);
+		occ = (occ - mask) & mask;
+	} while (occ);
+}
+
+static constexpr SliderTables BuildSliderTables()
+{
+	SliderTables t{};
+	for (int sq = 0; sq < 64; ++sq)
+	{
+		t.rookMasks[sq] = RookMask(sq);
+		t.bishopMasks[sq] = BishopMask(sq);
+		FillSlice(t.attacks + rookOffsets[sq], sq, t.rookMasks[sq], rookMagics[sq], rookShifts[sq], ComputeRookAttacks);
+		FillSlice(t.attacks + bishopOffsets[sq], sq, t.bishopMasks[sq], bishopMagics[sq], bishopShifts[sq], ComputeBishopAttacks);
+	}
+	return t;
 }
 
-inline int PopCount64(uint64_t x)
+static constexpr SliderTables sliders = BuildSliderTables();
+static constexpr const Bitboard (&rookMasks)[64] = sliders.rookMasks;
+static constexpr const Bitboard (&bishopMasks)[64] = sliders.bishopMasks;
+static constexpr const Bitboard (&sliderAttacks)[SLIDER_TABLE_SIZE] = sliders.attacks;
+
+// Pext gives the dense index directly, otherwise it's the magic multiply. Both land in the same slice
+static inline uint32_t RookIndex(int sq, Bitboard occ)
 {
-#if defined(_MSC_VER)
-	return (int)__popcnt64(x);
+#if defined(CHESS_PEXT_SLIDERS)
+	return (uint32_t)Pext(occ, rookMasks[sq]);
 #else
-	return __builtin_popcountll(x);
+	return (uint32_t)(((occ & rookMasks[sq]) * rookMagics[sq]) >> rookShifts[sq]);
 #endif
 }
 
-inline int FirstLSBIndex(Bitboard b)
+static inline uint32_t BishopIndex(int sq, Bitboard occ)
 {
-	if (!b) return -1;
-#if defined(_MSC_VER)
-	unsigned long idx32 = 0;
-	_BitScanForward64(&idx32, b);
-	return static_cast<int>(idx32);
+#if defined(CHESS_PEXT_SLIDERS)
+	return (uint32_t)Pext(occ, bishopMasks[sq]);
 #else
-	return __builtin_ctzll(b);
+	return (uint32_t)(((occ & bishopMasks[sq]) * bishopMagics[sq]) >> bishopShifts[sq]);
 #endif
 }
 
-// Define offsets and directions
-const int Movegen::bishopDirs[4] = {
-	-9,   -7,
+static inline Bitboard RookLookup(int sq, Bitboard occ) { return sliderAttacks[rookOffsets[sq] + RookIndex(sq, occ)]; }
+static inline Bitboard BishopLookup(int sq, Bitboard occ) { return sliderAttacks[bishopOffsets[sq] + BishopIndex(sq, occ)]; }
 
-	7,	   9
-};
-const int Movegen::rookDirs[4] = {
-		-8,
-	 -1,   1,
-		 8
-};
-const int Movegen::queenDirs[8] = {
-	-9, -8, -7,
-	-1,      1,
-	 7,  8,  9
+struct LineTables
+{
+	Bitboard between[64][64];
+	Bitboard line[64][64];
 };
 
-Bitboard pawnAttacks[2][64];
-Bitboard knightAttacks[64];
-Bitboard kingAttacks[64];
+static constexpr LineTables BuildLineTables()
+{
+	LineTables t{};
+	for (int a = 0; a < 64; ++a)
+	{
+		for (int b = 0; b < 64; ++b)
+		{
+			if (a == b) continue;
+			Bitboard aBit = 1ULL << a;
+			Bitboard bBit = 1ULL << b;
 
-Bitboard rookAttacks[64][4096];   // 4096 = 2^12, max rook relevant occupancy bits
-Bitboard bishopAttacks[64][512];  // 512 = 2^9, max bishop relevant occupancy bits
-Bitboard rookMasks[64];
-Bitboard bishopMasks[64];
+			// The empty board rays of both squares only overlap on the line they share
+			if (ComputeRookAttacks(a, 0) & bBit)
+			{
+				t.between[a][b] = ComputeRookAttacks(a, bBit) & ComputeRookAttacks(b, aBit);
+				t.line[a][b] = (ComputeRookAttacks(a, 0) & ComputeRookAttacks(b, 0)) | aBit | bBit;
+			}
+			else if (ComputeBishopAttacks(a, 0) & bBit)
+			{
+				t.between[a][b] = ComputeBishopAttacks(a, bBit) & ComputeBishopAttacks(b, aBit);
+				t.line[a][b] = (ComputeBishopAttacks(a, 0) & ComputeBishopAttacks(b, 0)) | aBit | bBit;
+			}
+		}
+	}
+	return t;
+}
+
+static constexpr LineTables lines = BuildLineTables();
 
 bool Movegen::IsSquareAttacked(int sq, Color byColor, const BitboardBoard& board)
 {
@@ -92,21 +325,202 @@ bool Movegen::IsSquareAttacked(int sq, Color byColor, const BitboardBoard& board
 	if (kingAttacks[sq] & board.pieceBitboards[c][static_cast<int>(Pieces::KING) - 1])
 		return true;
 
+	Bitboard queens = board.pieceBitboards[c][static_cast<int>(Pieces::QUEEN) - 1];
+
 	// Bishops / Queens (diagonals)
-	Bitboard bishopMoves = SlidingMoves(sq, byColor, Pieces::BISHOP, board, true);
-	if (bishopMoves & (board.pieceBitboards[c][static_cast<int>(Pieces::BISHOP) - 1] |
-		board.pieceBitboards[c][static_cast<int>(Pieces::QUEEN) - 1]))
+	if (BishopLookup(sq, board.occupied) & (board.pieceBitboards[c][static_cast<int>(Pieces::BISHOP) - 1] | queens))
 		return true;
 
 	// Rooks / Queens (orthogonal)
-	Bitboard rookMoves = SlidingMoves(sq, byColor, Pieces::ROOK, board, true);
-	if (rookMoves & (board.pieceBitboards[c][static_cast<int>(Pieces::ROOK) - 1] |
-		board.pieceBitboards[c][static_cast<int>(Pieces::QUEEN) - 1]))
+	if (RookLookup(sq, board.occupied) & (board.pieceBitboards[c][static_cast<int>(Pieces::ROOK) - 1] | queens))
 		return true;
 
 	return false;
 }
 
+Bitboard Movegen::AttackersTo(int sq, Bitboard occ, const BitboardBoard& board)
+{
+	const Bitboard(&white)[6] = board.pieceBitboards[0];
+	const Bitboard(&black)[6] = board.pieceBitboards[1];
+	Bitboard queens = white[4] | black[4];
+
+	return (pawnAttacks[1][sq] & white[0]) | (pawnAttacks[0][sq] & black[0]) // A pawn attacks sq if sq's opposite pawn attacks hit it
+		| (knightAttacks[sq] & (white[1] | black[1]))
+		| (kingAttacks[sq] & (white[5] | black[5]))
+		| (BishopLookup(sq, occ) & (white[2] | black[2] | queens))
+		| (RookLookup(sq, occ) & (white[3] | black[3] | queens));
+}
+
+Bitboard Movegen::Between(int a, int b)
+{
+	return lines.between[a][b];
+}
+
+Bitboard Movegen::Line(int a, int b)
+{
+	return lines.line[a][b];
+}
+
+// Piece type index (pawn 0) of color c on sq, -1 if there's none
+static int TypeAt(const BitboardBoard& board, int c, int sq)
+{
+	for (int t = 0; t < 6; ++t)
+		if (IsSet(board.pieceBitboards[c][t], sq))
+			return t;
+	return -1;
+}
+
+// Bitboards after the move, only for castling, en passant and promotions which the fast checks below don't cover
+static BitboardBoard BoardAfter(Move move, const BitboardBoard& board, int us)
+{
+	BitboardBoard after = board;
+	int from = GetStart(move);
+	int to = GetEnd(move);
+	int moved = TypeAt(board, us, from);
+	int captured = TypeAt(board, 1 - us, to);
+
+	auto toggle = [&](int c, int t, int sq)
+	{
+		Bitboard mask = 1ULL << sq;
+		after.pieceBitboards[c][t] ^= mask;
+		after.allPieces[c] ^= mask;
+		after.occupied ^= mask;
+	};
+
+	if (captured >= 0) toggle(1 - us, captured, to);
+	if (IsEnPassant(move)) toggle(1 - us, 0, to + (us == 0 ? 8 : -8));
+	toggle(us, moved, from);
+	toggle(us, GetPromotion(move) ? GetPromotion(move) - 1 : moved, to);
+
+	if (IsCastle(move))
+	{
+		int row = ToRow(from);
+		bool kingside = ToCol(to) > ToCol(from);
+		toggle(us, (int)Pieces::ROOK - 1, ToIndex(row, kingside ? 7 : 0));
+		toggle(us, (int)Pieces::ROOK - 1, ToIndex(row, kingside ? 5 : 3));
+	}
+	return after;
+}
+
+bool Movegen::IsLegal(Move move, const BitboardBoard& board, const AttackInfo& info)
+{
+	int us = info.us;
+	int them = 1 - us;
+	int king = info.kingSq[us];
+	int from = GetStart(move);
+	int to = GetEnd(move);
+	if (king < 0) return true;
+
+	if (IsEnPassant(move) || IsCastle(move))
+	{
+		BitboardBoard after = BoardAfter(move, board, us);
+		int kingAfter = IsCastle(move) ? to : king;
+		return !(AttackersTo(kingAfter, after.occupied, after) & after.allPieces[them]);
+	}
+
+	// King moves: nothing may hit the target once the king is off its square (so it can't hide behind itself)
+	if (from == king)
+		return !(AttackersTo(to, board.occupied ^ (1ULL << from), board) & board.allPieces[them]);
+
+	if (info.checkers & (info.checkers - 1))
+		return false; // Double check, only the king can move
+	if ((info.pinned[us] & (1ULL << from)) && !(Line(king, from) & (1ULL << to)))
+		return false;
+	if (info.checkers)
+		return ((Between(king, FirstLSBIndex(info.checkers)) | info.checkers) & (1ULL << to)) != 0; // Take or block
+
+	return true;
+}
+
+bool Movegen::GivesCheck(Move move, const BitboardBoard& board, const AttackInfo& info)
+{
+	int us = info.us;
+	int theirKing = info.kingSq[1 - us];
+	int from = GetStart(move);
+	int to = GetEnd(move);
+	if (theirKing < 0) return false;
+
+	if (IsEnPassant(move) || IsCastle(move) || GetPromotion(move))
+	{
+		BitboardBoard after = BoardAfter(move, board, us);
+		return (AttackersTo(theirKing, after.occupied, after) & after.allPieces[us]) != 0;
+	}
+
+	// Direct check, or a discovered one if the piece leaves the line to their king
+	if (info.checkSquares[TypeAt(board, us, from)] & (1ULL << to))
+		return true;
+	return (info.discoverers & (1ULL << from)) && !(Line(theirKing, from) & (1ULL << to));
+}
+
+int Movegen::SEE(Move move, const BitboardBoard& board, const AttackInfo& info)
+{
+	static constexpr int values[6] = { 100, 300, 325, 500, 900, 10000 }; // Same as move ordering
+
+	int from = GetStart(move);
+	int to = GetEnd(move);
+	int side = info.us;
+	int attacker = TypeAt(board, side, from);
+	int victim = IsEnPassant(move) ? 0 : TypeAt(board, 1 - side, to);
+	if (attacker < 0) return 0;
+
+	Bitboard occ = board.occupied ^ (1ULL << from);
+	if (IsEnPassant(move))
+		occ ^= 1ULL << (to + (side == 0 ? 8 : -8));
+
+	const Bitboard(&white)[6] = board.pieceBitboards[0];
+	const Bitboard(&black)[6] = board.pieceBitboards[1];
+	Bitboard diagonal = white[2] | black[2] | white[4] | black[4];
+	Bitboard orthogonal = white[3] | black[3] | white[4] | black[4];
+
+	// Pinned pieces only join in if taking keeps them on their line, the x-rays below skip them too
+	Bitboard pinnedOff = 0;
+	for (int c = 0; c < 2; ++c)
+		if (info.kingSq[c] >= 0)
+			pinnedOff |= info.pinned[c] & ~Line(info.kingSq[c], to);
+
+	Bitboard attackers = AttackersTo(to, occ, board) & occ & ~pinnedOff;
+
+	// Swap list: gain[d] is what the side taking at depth d is up if the exchange stops there, then each
+	// side gets to stop whenever going on is worse
+	int gain[32];
+	int depth = 0;
+	gain[0] = victim >= 0 ? values[victim] : 0;
+
+	while (depth < 31)
+	{
+		side ^= 1;
+		Bitboard mine = attackers & board.allPieces[side];
+		if (!mine) break;
+
+		// Least valuable one takes next
+		int type = 0;
+		Bitboard pieces;
+		while (!(pieces = mine & board.pieceBitboards[side][type]))
+			++type;
+
+		if (type == 5 && (attackers & board.allPieces[side ^ 1]))
+			break; // King can't take a defended piece
+
+		++depth;
+		gain[depth] = values[attacker] - gain[depth - 1];
+
+		Bitboard fromBit = pieces & (0 - pieces);
+		occ ^= fromBit;
+		attackers ^= fromBit;
+
+		// Sliders lined up behind it, pieces that already took are out of occ
+		attackers |= ((BishopLookup(to, occ) & diagonal) | (RookLookup(to, occ) & orthogonal)) & occ & ~pinnedOff;
+		attacker = type;
+	}
+
+	while (depth > 0)
+	{
+		gain[depth - 1] = -std::max(-gain[depth - 1], gain[depth]);
+		--depth;
+	}
+	return gain[0];
+}
+
 // Valid moves for a single piece
 std::vector<uint8_t> Movegen::GetValidMoves(int sq, const BitboardBoard& board)
 {
@@ -172,16 +586,10 @@ std::vector<Move> Movegen::GetAllLegalMoves(Color color, const BitboardBoard& bo
 	std::vector<Move> moves;
 
 	GetAllMoves(moves, color, board, engine);
+	const AttackInfo& info = engine->GetAttackInfo();
 	moves.erase(
 		std::remove_if(moves.begin(), moves.end(),
-			[&](Move move)
-			{
-				// Remove moves that cause checks
-				engine->MakeMove(move);
-				bool inCheck = engine->InCheck(Opponent(GameState::currentPlayer));
-				engine->UndoMove();
-				return inCheck;
-			}),
+			[&](Move move) { return !IsLegal(move, board, info); }), // Remove moves that leave the king in check
 		moves.end()
 	);
 
@@ -193,6 +601,7 @@ void Movegen::GetAllMoves(std::vector<Move>& moves, Color color, const BitboardB
 {
 	moves.clear();
 	int c = IsWhite(color) ? 0 : 1;
+	const AttackInfo* info = onlyNoisy ? &engine->GetAttackInfo() : nullptr;
 
 	// Iterate pieces by bitboards
 	for (int t = 0; t < 6; ++t)
@@ -244,10 +653,8 @@ void Movegen::GetAllMoves(std::vector<Move>& moves, Color color, const BitboardB
 					}
 
 					// Checks
-					engine->MakeMove(move);
-					if (engine->InCheck(GameState::currentPlayer))
+					if (GivesCheck(move, board, *info))
 						moves.push_back(move);
-					engine->UndoMove();
 				}
 				else
 					moves.push_back(move);
@@ -263,24 +670,6 @@ std::vector<Move> Movegen::GetAllMoves(Color color, const BitboardBoard& board,
 	return moves;
 }
 
-Bitboard Movegen::GetPseudoAttacks(Pieces piece, int sq, const Bitboard& allOcc, bool isWhite)
-{
-	// TODO: Might need to fill in the pieces bitboards too for accurate movegen
-	Bitboard moves = EMPTY_BITBOARD;
-	Color color = isWhite ? Color::WHITE : Color::BLACK;
-	switch (piece)
-	{
-	case Pieces::PAWN:   moves = PawnMoves(sq, color, BitboardBoard{ {}, {}, allOcc }); break;
-	case Pieces::KNIGHT: moves = KnightMoves(sq, color, BitboardBoard{ {}, {}, allOcc }); break;
-	case Pieces::BISHOP: moves = SlidingMoves(sq, color, Pieces::BISHOP, BitboardBoard{ {}, {}, allOcc }); break;
-	case Pieces::ROOK:   moves = SlidingMoves(sq, color, Pieces::ROOK, BitboardBoard{ {}, {}, allOcc }); break;
-	case Pieces::QUEEN:  moves = SlidingMoves(sq, color, Pieces::QUEEN, BitboardBoard{ {}, {}, allOcc }); break;
-	case Pieces::KING:   moves = KingMoves(sq, color, BitboardBoard{ {}, {}, allOcc }); break;
-	default: break;
-	}
-	return moves;
-}
-
 const Bitboard(&Movegen::GetPawnAttacks())[2][64]
 {
 	return pawnAttacks;
@@ -293,13 +682,22 @@ const Bitboard(&Movegen::GetKingAttacks())[64]
 {
 	return kingAttacks;
 }
-const Bitboard(&Movegen::GetRookAttacks())[64][4096]
+Bitboard Movegen::RookAttacks(int sq, Bitboard occ)
 {
-	return rookAttacks;
+	return RookLookup(sq, occ);
 }
-const Bitboard(&Movegen::GetBishopAttacks())[64][512]
+Bitboard Movegen::BishopAttacks(int sq, Bitboard occ)
 {
-	return bishopAttacks;
+	return BishopLookup(sq, occ);
+}
+
+const char* Movegen::SliderLookupName()
+{
+#if defined(CHESS_PEXT_SLIDERS)
+	return "pext";
+#else
+	return "magic";
+#endif
 }
 
 Bitboard Movegen::KingMoves(int sq, Color color, const BitboardBoard& board)
@@ -365,227 +763,12 @@ Bitboard Movegen::SlidingMoves(int sq, Color color, const Pieces piece,
 	bool bishopMoves = (piece == Pieces::BISHOP || piece == Pieces::QUEEN);
 
 	if (rookMoves)
-	{
-		Bitboard occR = occ & rookMasks[sq];
-		uint64_t idxR = (occR * rookMagics[sq]) >> rookShifts[sq];
-		moves |= rookAttacks[sq][idxR];
-	}
+		moves |= RookLookup(sq, occ);
 	if (bishopMoves)
-	{
-		Bitboard occB = occ & bishopMasks[sq];
-		uint64_t idxB = (occB * bishopMagics[sq]) >> bishopShifts[sq];
-		moves |= bishopAttacks[sq][idxB];
-	}
+		moves |= BishopLookup(sq, occ);
 
 	if (!includeBlockers)
 		moves &= ~board.allPieces[(int)color];
 
 	return moves;
 }
-
-// Precompute knight and king attacks
-void Movegen::InitPrecomputedAttacks()
-{
-	for (int sq = 0; sq < 64; ++sq)
-	{
-		int r = ToRow(sq);
-		int c = ToCol(sq);
-
-		// Knight moves
-		Bitboard mask = EMPTY_BITBOARD;
-
-		int dr[8] = { 2,  2, 1,  1, -1, -1, -2, -2 };
-		int dc[8] = { 1, -1, 2, -2,  2, -2,  1, -1 };
-
-		for (int i = 0; i < 8; ++i)
-		{
-			int nr = r + dr[i];
-			int nc = c + dc[i];
-
-			if (InBounds(nr, nc))
-				mask |= 1ULL << ToIndex(nr, nc);
-		}
-		knightAttacks[sq] = mask;
-
-		// King moves
-		mask = EMPTY_BITBOARD;
-		for (int dr = -1; dr <= 1; ++dr)
-		{
-			for (int dc = -1; dc <= 1; ++dc)
-			{
-				if (dr == 0 && dc == 0) continue;
-				int nr = r + dr;
-				int nc = c + dc;
-				if (InBounds(nr, nc))
-					mask |= 1ULL << ToIndex(nr, nc);
-			}
-		}
-		kingAttacks[sq] = mask;
-
-		// Pawn attacks
-		// White pawns
-		mask = EMPTY_BITBOARD;
-		if (InBounds(r - 1, c - 1)) mask |= 1ULL << ToIndex(r - 1, c - 1);
-		if (InBounds(r - 1, c + 1)) mask |= 1ULL << ToIndex(r - 1, c + 1);
-		pawnAttacks[(int)Color::WHITE][sq] = mask;
-
-		mask = EMPTY_BITBOARD;
-		if (InBounds(r + 1, c - 1)) mask |= 1ULL << ToIndex(r + 1, c - 1);
-		if (InBounds(r + 1, c + 1)) mask |= 1ULL << ToIndex(r + 1, c + 1);
-		pawnAttacks[(int)Color::BLACK][sq] = mask;
-	}
-
-	BuildMagicAttackTables();
-}
-
-static Bitboard RookMask(int sq)
-{
-	Bitboard mask = 0ULL;
-	int rank = ToRow(sq);
-	int file = ToCol(sq);
-
-	// North
-	for (int r = rank + 1; r <= 6; r++) mask |= 1ULL << ToIndex(r, file);
-	// South
-	for (int r = rank - 1; r >= 1; r--) mask |= 1ULL << ToIndex(r, file);
-	// East
-	for (int f = file + 1; f <= 6; f++) mask |= 1ULL << ToIndex(rank, f);
-	// West
-	for (int f = file - 1; f >= 1; f--) mask |= 1ULL << ToIndex(rank, f);
-
-	return mask;
-}
-
-static Bitboard BishopMask(int sq)
-{
-	Bitboard mask = 0ULL;
-	int r = ToRow(sq), c = ToCol(sq);
-
-	const int dr[4] = { -1, -1, 1, 1 };
-	const int dc[4] = { -1, 1, -1, 1 };
-
-	for (int dir = 0; dir < 4; ++dir)
-	{
-		int tr = r + dr[dir];
-		int tc = c + dc[dir];
-		while (InBounds(tr, tc))
-		{
-			// Stop before the edge square
-			if (tr == 0 || tr == 7 || tc == 0 || tc == 7) break;
-			Set(mask, ToIndex(tr, tc));
-			tr += dr[dir];
-			tc += dc[dir];
-		}
-	}
-	return mask;
-}
-
-static Bitboard SetOccupancy(int index, int bitsCount, Bitboard mask)
-{
-	Bitboard occ = 0ULL;
-	int bitIndex = 0;
-	for (int sq = 0; sq < 64; ++sq)
-	{
-		if (mask & (1ULL << sq))
-		{
-			if (index & (1 << bitIndex))
-				occ |= (1ULL << sq);
-			++bitIndex;
-			if (bitIndex >= bitsCount) break;
-		}
-	}
-	return occ;
-}
-
-static Bitboard ComputeRookAttacks(int sq, Bitboard occ)
-{
-	Bitboard attacks = 0ULL;
-	int r = ToRow(sq), c = ToCol(sq);
-
-	const int dr[4] = { -1, 0, 0, 1 };
-	const int dc[4] = { 0, -1, 1, 0 };
-
-	for (int dir = 0; dir < 4; ++dir)
-	{
-		int tr = r + dr[dir];
-		int tc = c + dc[dir];
-		while (InBounds(tr, tc))
-		{
-			int t = ToIndex(tr, tc);
-			attacks |= (1ULL << t);
-			if (occ & (1ULL << t)) break; // Blocked
-			tr += dr[dir];
-			tc += dc[dir];
-		}
-	}
-	return attacks;
-}
-
-static Bitboard ComputeBishopAttacks(int sq, Bitboard occ)
-{
-	Bitboard attacks = 0ULL;
-	int r = ToRow(sq), c = ToCol(sq);
-
-	const int dr[4] = { -1, -1, 1, 1 };
-	const int dc[4] = { -1, 1, -1, 1 };
-
-	for (int dir = 0; dir < 4; ++dir)
-	{
-		int tr = r + dr[dir];
-		int tc = c + dc[dir];
-		while (InBounds(tr, tc))
-		{
-			int t = ToIndex(tr, tc);
-			attacks |= (1ULL << t);
-			if (occ & (1ULL << t)) break; // Blocked
-			tr += dr[dir];
-			tc += dc[dir];
-		}
-	}
-	return attacks;
-}
-
-void Movegen::BuildMagicAttackTables()
-{
-	for (int sq = 0; sq < 64; ++sq)
-	{
-		// Rook
-		{
-			Bitboard mask = RookMask(sq);
-			rookMasks[sq] = mask;
-
-			int bits = PopCount64(mask);
-			int tableSize = 1 << bits;
-
-			for (int i = 0; i < tableSize; ++i)
-			{
-				Bitboard occ = SetOccupancy(i, bits, mask);
-				uint64_t index = (occ * rookMagics[sq]) >> rookShifts[sq];
-				rookAttacks[sq][index] = ComputeRookAttacks(sq, occ);
-			}
-
-			// Handle trivial edge squares (no relevant bits)
-			if (bits == 0)
-				rookAttacks[sq][0] = ComputeRookAttacks(sq, 0ULL);
-		}
-
-		// Bishop
-		{
-			Bitboard mask = BishopMask(sq);
-			bishopMasks[sq] = mask;
-
-			int bits = PopCount64(mask);
-			int tableSize = 1 << bits;
-
-			for (int i = 0; i < tableSize; ++i)
-			{
-				Bitboard occ = SetOccupancy(i, bits, mask);
-				uint64_t index = (occ * bishopMagics[sq]) >> bishopShifts[sq];
-				bishopAttacks[sq][index] = ComputeBishopAttacks(sq, occ);
-			}
-
-			if (bits == 0)
-				bishopAttacks[sq][0] = ComputeBishopAttacks(sq, 0ULL);
-		}
-	}
-}
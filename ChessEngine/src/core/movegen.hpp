@@ -6,6 +6,13 @@
 #include "move.hpp"
 #include "bitboard.hpp"
 
+struct AttackInfo;
+
+// Pext slider lookup on bmi2 builds, -DCHESS_NO_PEXT forces magics (e.g. to compare them)
+#if defined(__BMI2__) && !defined(CHESS_NO_PEXT)
+#define CHESS_PEXT_SLIDERS
+#endif
+
 class Movegen
 {
 public:
@@ -18,18 +25,31 @@ public:
 	// This is pseudo-legal moves, it does not check for checks for faster engine calculations
 	static void GetAllMoves(std::vector<Move>& moves, Color color, const BitboardBoard& board, Engine* engine, bool onlyNoisy = false);
 	static std::vector<Move> GetAllMoves(Color color, const BitboardBoard& board, Engine* engine, bool onlyCaptures = false);
-	static Bitboard GetPseudoAttacks(Pieces piece, int sq, const Bitboard& allOcc, bool isWhite);
 
-	static void InitPrecomputedAttacks();
-	static void BuildMagicAttackTables();
 	//static void GenerateAndInitMagics(bool dumpToHeader, const std::string& outPath);
 
 	// TODO: Creating a definition in the cpp file breaks the ide lmao
 	static const Bitboard(&GetPawnAttacks())[2][64];
 	static const Bitboard(&GetKnightAttacks())[64];
 	static const Bitboard(&GetKingAttacks())[64];
-	static const Bitboard(&GetRookAttacks())[64][4096];
-	static const Bitboard(&GetBishopAttacks())[64][512];
+
+	// Slider attacks for any occupancy, through pext or magics depending on the build
+	static Bitboard RookAttacks(int sq, Bitboard occ);
+	static Bitboard BishopAttacks(int sq, Bitboard occ);
+	static const char* SliderLookupName();
+
+	// Pieces of both colors attacking sq with occupancy occ (take pieces out of occ to see x-rays)
+	static Bitboard AttackersTo(int sq, Bitboard occ, const BitboardBoard& board);
+	// Squares strictly between a and b if they share a rank, file or diagonal, empty otherwise
+	static Bitboard Between(int a, int b);
+	// The whole line through a and b, edge to edge, empty if they don't share one
+	static Bitboard Line(int a, int b);
+
+	// Same answers as making the move and looking at checkStatus, off the side to move's AttackInfo
+	static bool IsLegal(Move move, const BitboardBoard& board, const AttackInfo& info);
+	static bool GivesCheck(Move move, const BitboardBoard& board, const AttackInfo& info);
+	// Static exchange evaluation of the capture on the move's target square, material the mover comes out with
+	static int SEE(Move move, const BitboardBoard& board, const AttackInfo& info);
 
 private:
 	static Bitboard KingMoves(int sq, Color color, const BitboardBoard& board);
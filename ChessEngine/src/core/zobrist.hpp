@@ -16,7 +16,29 @@ struct Zobrist
     uint64_t castling[4];     // Order: WK, WQ, BK, BQ (choose your mapping)
     uint64_t enPassantFile[8]; // File 0..7
 
-    Zobrist();
+    constexpr Zobrist()
+        : piece{}, sideToMove(0), castling{}, enPassantFile{}
+    {
+        init();
+    }
 
-    void init();
-};
\ No newline at end of file
+    constexpr void init()
+    {
+        for (int p = 0; p < 12; ++p)
+            for (int s = 0; s < 64; ++s)
+                piece[p][s] = Random64[(p * 64) + (s ^ 56)]; // Indexed by engine square (0 = a8), Polyglot's 0 is a1
+
+        castling[0] = Random64[768]; // WK
+        castling[1] = Random64[769]; // WQ
+        castling[2] = Random64[770]; // BK
+        castling[3] = Random64[771]; // BQ
+
+        for (int f = 0; f < 8; ++f)
+            enPassantFile[f] = Random64[772 + f];
+
+        sideToMove = Random64[780];
+    }
+};
+
+// The keys never change (Polyglot's Random64) so they're made at compile time, one copy for everyone
+inline constexpr Zobrist zobristKeys;
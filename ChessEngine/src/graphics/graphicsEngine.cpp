@@ -2,7 +2,7 @@
 
 #include <iostream>
 
-#include <SDL/SDL_image.h>
+#include <SDL_image.h>
 
 #include "core/boardCalculator.hpp"
 #include "core/gameState.hpp"
@@ -197,6 +197,8 @@ void GraphicsEngine::Initialize()
 
 void GraphicsEngine::Shutdown()
 {
+	if (window == nullptr) return; // Never opened (uci)
+
 	SDL_DestroyRenderer(renderer);
 	SDL_DestroyWindow(window);
 	SDL_Quit();
@@ -7,8 +7,16 @@
 #include "core/square.hpp"
 #include "core/piece.hpp"
 
-#include <SDL/SDL.h>
+#if defined(CHESS_HEADLESS)
+// No SDL in headless builds, just enough for the interface to compile (see headlessGraphics.cpp)
+struct SDL_Color { uint8_t r, g, b, a; };
+struct SDL_Texture;
+struct SDL_Window;
+struct SDL_Renderer;
+#else
+#include <SDL.h>
 #undef main
+#endif
 
 class GraphicsEngine
 {
@@ -30,9 +38,9 @@ private:
 
 	std::vector<std::function<void()>> queuedRenders;
 
-	SDL_Texture* pieceTextures[12];
-	SDL_Window* window;
-	SDL_Renderer* renderer;
+	SDL_Texture* pieceTextures[12] = {};
+	SDL_Window* window = nullptr;
+	SDL_Renderer* renderer = nullptr;
 };
 
 template<typename F>
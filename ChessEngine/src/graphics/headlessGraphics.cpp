@@ -0,0 +1,23 @@
+#include "graphicsEngine.hpp"
+
+// Stand in for graphicsEngine.cpp in headless builds (CHESS_HEADLESS), nothing is drawn and there's no input
+
+GraphicsEngine::GraphicsEngine() {}
+
+GraphicsEngine::~GraphicsEngine() {}
+
+void GraphicsEngine::Render(const Square board[64]) { queuedRenders.clear(); }
+
+void GraphicsEngine::RenderBoard(const Square board[64]) {}
+
+void GraphicsEngine::RenderPieces(const Square board[64]) {}
+
+void GraphicsEngine::RenderBitboard(uint64_t bitboard) {}
+
+int GraphicsEngine::GetInputs() { return -1; }
+
+void GraphicsEngine::DrawSquareHighlight(int sq, SDL_Color color) {}
+
+void GraphicsEngine::Initialize() {}
+
+void GraphicsEngine::Shutdown() {}
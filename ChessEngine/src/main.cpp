@@ -4,14 +4,17 @@
 #include "bot/opening.hpp"
 
 #include "test.hpp"
+#include "cli.hpp"
+#include "core/cpu.hpp"
 
 #include <memory>
+#include <string>
+#include <cstdlib>
 
 // TODO: Sometimes using uint8_t for moves has very weird memory bugs, like setting the move col to 204 in GetAllMoves
 // 
 // TODO: Move extension (check, recapture, passed pawn, pv line)
 // TODO: Aspiration window
-// TODO: SEE for capture pruning (qsearch)
 // TODO: Pawn hash (for eval of pawn positions)
 // TODO: Asymmetric search
 // TODO: Keep track of pv line
@@ -27,8 +30,17 @@
 // row col 0, 0 is a8
 // TODO: King is gone
 
-int main()
+int main(int argc, char* argv[])
 {
+    // Hand over to the fastest build for this cpu if there's one next to us
+    int exitCode = 0;
+    if (Cpu::DispatchToBestFlavor(argc, argv, exitCode))
+        return exitCode;
+
+    // ChessEngine bench/perft ..., see cli.hpp
+    if (RunToolCommand(argc, argv, exitCode))
+        return exitCode;
+
     const char* fen = "4k2r/6r1/8/8/8/8/3R4/R3K3 w Qk - 0 1";
     const char* fen2 = "4r1k1/4r1p1/8/p2R1P1K/5P1P/1QP3q1/1P6/3R4 b - - 0 1";
     const char* fen3 = "8/K7/8/8/2k5/8/8/1B6 w - - 33 64";
@@ -39,7 +51,11 @@ int main()
     const char* start = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
     const char* enMis = "7r/1Q3ppp/p7/2k4q/3PB3/8/1PP1NP2/1NB1KR2 w - - 1 24";
     const char* pawn = "K7/2P5/8/8/4pP2/8/5b2/k7 w - - 0 1";
+#if defined(CHESS_HEADLESS)
+    GameState::uci = true; // No window to play in
+#else
     GameState::uci = false; // Used for bot v. bot iteration testing
+#endif
     std::unique_ptr<Engine> chessEngine = std::make_unique<Engine>();
     // Smart ptr so I don't need delete at end of file (lazy)
 	std::unique_ptr<Bot> whiteBot = std::make_unique<Bot>(chessEngine.get(), Color::WHITE);
@@ -0,0 +1,257 @@
+#include "notation.hpp"
+
+#include <vector>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+
+#include "core/movegen.hpp"
+#include "core/gameState.hpp"
+#include "core/boardCalculator.hpp"
+
+static void GenerateLegal(Engine* engine, std::vector<Move>& moves)
+{
+    Color us = GameState::currentPlayer;
+    moves.clear();
+    Movegen::GetAllMoves(moves, us, engine->GetBitboardBoard(), engine);
+
+    size_t legal = 0;
+    for (size_t i = 0; i < moves.size(); ++i)
+    {
+        engine->MakeMove(moves[i]);
+        bool inCheck = engine->InCheck(us);
+        engine->UndoMove();
+
+        if (!inCheck)
+            moves[legal++] = moves[i];
+    }
+    moves.resize(legal);
+}
+
+// "+" or "#" if the move gives check/mate
+static std::string CheckSuffix(Move move, Engine* engine)
+{
+    Color us = GameState::currentPlayer;
+    engine->MakeMove(move);
+
+    std::string suffix;
+    if (engine->InCheck(Opponent(us)))
+    {
+        std::vector<Move> replies;
+        GenerateLegal(engine, replies);
+        suffix = replies.empty() ? "#" : "+";
+    }
+    engine->UndoMove();
+    return suffix;
+}
+
+static Pieces PieceFromSAN(char c)
+{
+    switch (c)
+    {
+    case 'N': return Pieces::KNIGHT;
+    case 'B': return Pieces::BISHOP;
+    case 'R': return Pieces::ROOK;
+    case 'Q': return Pieces::QUEEN;
+    case 'K': return Pieces::KING;
+    default:  return Pieces::NONE;
+    }
+}
+
+Move ParseSAN(const std::string& sanIn, Engine* engine)
+{
+    // Drop check marks and annotations
+    std::string san = sanIn;
+    while (!san.empty() && (san.back() == '+' || san.back() == '#' || san.back() == '!' || san.back() == '?'))
+        san.pop_back();
+    if (san.size() < 2) return Move();
+
+    static thread_local std::vector<Move> legal;
+    GenerateLegal(engine, legal);
+
+    // Castling, some files use zeros
+    if (san == "O-O" || san == "0-0" || san == "O-O-O" || san == "0-0-0")
+    {
+        int col = (san.size() == 3) ? 6 : 2;
+        for (const Move& m : legal)
+            if (IsCastle(m) && ToCol(GetEnd(m)) == col)
+                return m;
+        return Move();
+    }
+
+    Pieces piece = PieceFromSAN(san[0]);
+    size_t i = 0;
+    if (piece == Pieces::NONE) piece = Pieces::PAWN;
+    else i = 1;
+
+    // Promotion, "e8=Q" or "e8Q"
+    Pieces promotion = Pieces::NONE;
+    size_t eq = san.find('=');
+    if (eq != std::string::npos)
+    {
+        if (eq + 1 >= san.size()) return Move();
+        promotion = PieceFromSAN(san[eq + 1]);
+        san.resize(eq);
+    }
+    else if (piece == Pieces::PAWN && PieceFromSAN(san.back()) != Pieces::NONE)
+    {
+        promotion = PieceFromSAN(san.back());
+        san.pop_back();
+    }
+
+    // What's left is [from file][from rank][x]<to square>
+    std::string body;
+    for (size_t j = i; j < san.size(); ++j)
+        if (san[j] != 'x' && san[j] != '-') body += san[j];
+    if (body.size() < 2) return Move();
+
+    char toFile = body[body.size() - 2];
+    char toRank = body[body.size() - 1];
+    if (toFile < 'a' || toFile > 'h' || toRank < '1' || toRank > '8') return Move();
+    int to = ToIndex('8' - toRank, toFile - 'a'); // Row 0 is rank 8
+
+    int fromCol = -1, fromRow = -1;
+    for (size_t j = 0; j + 2 < body.size(); ++j)
+    {
+        if (body[j] >= 'a' && body[j] <= 'h') fromCol = body[j] - 'a';
+        else if (body[j] >= '1' && body[j] <= '8') fromRow = '8' - body[j];
+        else return Move();
+    }
+
+    Move found = Move();
+    int matches = 0;
+    for (const Move& m : legal)
+    {
+        int from = GetStart(m);
+        if (GetEnd(m) != to || IsCastle(m)) continue;
+        if (engine->GetBoard()[from].GetPiece().GetType() != piece) continue;
+        if ((Pieces)GetPromotion(m) != promotion) continue;
+        if (fromCol != -1 && ToCol(from) != fromCol) continue;
+        if (fromRow != -1 && ToRow(from) != fromRow) continue;
+
+        found = m;
+        ++matches;
+    }
+    return matches == 1 ? found : Move();
+}
+
+std::string MoveToSAN(Move move, Engine* engine)
+{
+    static const char pieceLetters[] = " PNBRQK";
+
+    if (IsCastle(move))
+    {
+        std::string san = ToCol(GetEnd(move)) == 6 ? "O-O" : "O-O-O";
+        return san + CheckSuffix(move, engine);
+    }
+
+    static thread_local std::vector<Move> legal;
+    GenerateLegal(engine, legal);
+
+    int from = GetStart(move);
+    int to = GetEnd(move);
+    Pieces piece = engine->GetBoard()[from].GetPiece().GetType();
+    bool capture = IsEnPassant(move) || engine->GetBoard()[to].GetPiece().GetType() != Pieces::NONE;
+
+    std::string san;
+    if (piece == Pieces::PAWN)
+    {
+        if (capture) san += (char)('a' + ToCol(from));
+    }
+    else
+    {
+        san += pieceLetters[(int)piece];
+
+        // Another piece of the same kind can reach the square too
+        bool ambiguous = false, sameCol = false, sameRow = false;
+        for (const Move& m : legal)
+        {
+            if (m == move || GetEnd(m) != to || GetStart(m) == from) continue;
+            if (engine->GetBoard()[GetStart(m)].GetPiece().GetType() != piece) continue;
+
+            ambiguous = true;
+            if (ToCol(GetStart(m)) == ToCol(from)) sameCol = true;
+            if (ToRow(GetStart(m)) == ToRow(from)) sameRow = true;
+        }
+        if (ambiguous)
+        {
+            if (!sameCol) san += (char)('a' + ToCol(from));
+            else if (!sameRow) san += (char)('8' - ToRow(from));
+            else { san += (char)('a' + ToCol(from)); san += (char)('8' - ToRow(from)); }
+        }
+    }
+
+    if (capture) san += 'x';
+    san += (char)('a' + ToCol(to));
+    san += (char)('8' - ToRow(to));
+
+    if ((Pieces)GetPromotion(move) != Pieces::NONE)
+    {
+        san += '=';
+        san += pieceLetters[GetPromotion(move)];
+    }
+    return san + CheckSuffix(move, engine);
+}
+
+bool ParseEPDLine(const std::string& line, std::string& fen, std::string& id)
+{
+    std::istringstream iss(line);
+    std::string fields[4];
+    for (std::string& field : fields)
+        if (!(iss >> field)) return false;
+
+    if (std::count(fields[0].begin(), fields[0].end(), '/') != 7) return false;
+    if (fields[1] != "w" && fields[1] != "b") return false;
+
+    fen = fields[0] + " " + fields[1] + " " + fields[2] + " " + fields[3];
+
+    std::string rest;
+    std::getline(iss, rest);
+    std::istringstream clocks(rest);
+    int halfmove, fullmove;
+    std::string operations = rest;
+    if (clocks >> halfmove >> fullmove)
+        std::getline(clocks, operations);
+    else
+    {
+        // EPD keeps the clocks in hmvc/fmvn opcodes, if at all
+        std::string value;
+        halfmove = FindEPDOpcode(rest, "hmvc", value) ? std::max(0, std::atoi(value.c_str())) : 0;
+        fullmove = FindEPDOpcode(rest, "fmvn", value) ? std::max(1, std::atoi(value.c_str())) : 1;
+    }
+    fen += " " + std::to_string(halfmove) + " " + std::to_string(fullmove);
+
+    if (!FindEPDOpcode(operations, "id", id)) id.clear();
+    return true;
+}
+
+bool FindEPDOpcode(const std::string& operations, const std::string& opcode, std::string& value)
+{
+    size_t pos = 0;
+    while (pos < operations.size())
+    {
+        // One operation: opcode, operands, ';' (which can also be inside a quoted operand)
+        size_t start = operations.find_first_not_of(" \t\r", pos);
+        if (start == std::string::npos) break;
+        size_t end = start;
+        bool quoted = false;
+        while (end < operations.size() && (quoted || operations[end] != ';'))
+        {
+            if (operations[end] == '"') quoted = !quoted;
+            ++end;
+        }
+
+        std::string operation = operations.substr(start, end - start);
+        size_t split = operation.find_first_of(" \t");
+        if (operation.substr(0, split) == opcode)
+        {
+            value = split == std::string::npos ? "" : operation.substr(operation.find_first_not_of(" \t", split));
+            while (!value.empty() && (value.back() == ' ' || value.back() == '\t' || value.back() == '\r')) value.pop_back();
+            if (value.size() >= 2 && value.front() == '"' && value.back() == '"')
+                value = value.substr(1, value.size() - 2);
+            return true;
+        }
+        pos = end + 1;
+    }
+    return false;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#include <string>
+
+#include "core/engine.hpp"
+
+// One SAN move ("Nbd7", "exd8=Q+", "O-O") in the engine's current position, null move if it doesn't match exactly one legal move
+Move ParseSAN(const std::string& san, Engine* engine);
+
+// SAN for a legal move in the engine's current position, with disambiguation and +/#
+std::string MoveToSAN(Move move, Engine* engine);
+
+// "<board> <side> <castling> <ep> [halfmove fullmove | opcodes]", EPD lines take the clocks from hmvc/fmvn or get "0 1"
+// id comes from an `id "..."` opcode if there is one. False if the line isn't a position
+bool ParseEPDLine(const std::string& line, std::string& fen, std::string& id);
+
+// Operand of an EPD opcode (`ce 35;`, `c9 "1-0";`) in the operations after the four position fields, quotes stripped
+bool FindEPDOpcode(const std::string& operations, const std::string& opcode, std::string& value);
@@ -0,0 +1,291 @@
+#include "perft.hpp"
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <map>
+
+#include "core/movegen.hpp"
+#include "core/gameState.hpp"
+
+using namespace std::chrono;
+
+// One list per ply so nothing gets allocated while recursing
+static constexpr int PERFT_MAX_DEPTH = 32;
+static thread_local std::vector<Move> perftMoves[PERFT_MAX_DEPTH];
+
+struct PerftPosition
+{
+    const char* name;
+    const char* fen;
+    uint64_t expected[7]; // Depth 1.., 0 = not listed
+};
+
+// https://www.chessprogramming.org/Perft_Results
+static const PerftPosition perftPositions[] = {
+    { "Start",    "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1",
+        { 20, 400, 8902, 197281, 4865609, 119060324, 0 } },
+    { "Kiwipete", "r3k2r/p1ppqpb1/bn2pnp1/3PN3/1p2P3/2N2Q1p/PPPBBPPP/R3K2R w KQkq - 0 1",
+        { 48, 2039, 97862, 4085603, 193690690, 0, 0 } },
+    { "Position 3", "8/2p5/3p4/KP5r/1R3p1k/8/4P1P1/8 w - - 0 1",
+        { 14, 191, 2812, 43238, 674624, 11030083, 178633661 } },
+    { "Position 4", "r3k2r/Pppp1ppp/1b3nbN/nP6/BBP1P3/q4N2/Pp1P2PP/R2Q1RK1 w kq - 0 1",
+        { 6, 264, 9467, 422333, 15833292, 706045033, 0 } },
+    { "Position 5", "rnbq1k1r/pp1Pbppp/2p5/8/2B5/8/PPP1NnPP/RNBQK2R w KQ - 1 8",
+        { 44, 1486, 62379, 2103487, 89941194, 0, 0 } },
+    { "Position 6", "r4rk1/1pp1qppp/p1np1n2/2b1p1B1/2B1P1b1/P1NP1N2/1PP1QPPP/R4RK1 w - - 0 10",
+        { 46, 2079, 89890, 3894594, 164075551, 0, 0 } },
+};
+
+PerftTable::PerftTable(int megabytes)
+{
+    size_t entries = (megabytes * 1024ull * 1024ull) / sizeof(Entry);
+
+    // Round down to power of 2 for masking
+    size_t p2 = 1;
+    while (p2 * 2 <= entries) p2 *= 2;
+
+    table = std::make_unique<Entry[]>(p2);
+    mask = p2 - 1;
+    Clear();
+}
+
+bool PerftTable::Probe(uint64_t key, int depth, uint64_t& nodes) const
+{
+    const Entry& e = table[key & mask];
+    uint64_t data = e.data.load(std::memory_order_relaxed);
+    uint64_t keyXorData = e.keyXorData.load(std::memory_order_relaxed);
+    if ((keyXorData ^ data) != key || (int)(data & 0xFF) != depth)
+        return false;
+
+    nodes = data >> 8;
+    return true;
+}
+
+void PerftTable::Store(uint64_t key, int depth, uint64_t nodes)
+{
+    Entry& e = table[key & mask];
+    uint64_t data = (nodes << 8) | (uint64_t)(depth & 0xFF);
+    e.keyXorData.store(key ^ data, std::memory_order_relaxed);
+    e.data.store(data, std::memory_order_relaxed);
+}
+
+void PerftTable::Clear()
+{
+    for (size_t i = 0; i <= mask; ++i)
+    {
+        table[i].keyXorData.store(0, std::memory_order_relaxed);
+        table[i].data.store(0, std::memory_order_relaxed);
+    }
+}
+
+// Pseudo legal moves filtered off the position's pins and checks, same as GetAllLegalMoves but into a reused list
+static void GenerateLegal(Engine* engine, std::vector<Move>& moves)
+{
+    Color us = GameState::currentPlayer;
+    const BitboardBoard& board = engine->GetBitboardBoard();
+    Movegen::GetAllMoves(moves, us, board, engine);
+
+    const AttackInfo& info = engine->GetAttackInfo();
+    size_t legal = 0;
+    for (size_t i = 0; i < moves.size(); ++i)
+        if (Movegen::IsLegal(moves[i], board, info))
+            moves[legal++] = moves[i];
+    moves.resize(legal);
+}
+
+static uint64_t PerftRecurse(Engine* engine, int depth, int ply, PerftTable* tt)
+{
+    std::vector<Move>& moves = perftMoves[ply];
+
+    // Bulk count, the legal moves are the leaves
+    if (depth == 1)
+    {
+        GenerateLegal(engine, moves);
+        return moves.size();
+    }
+
+    uint64_t key = engine->GetZobristKey();
+    uint64_t nodes = 0;
+    if (tt && tt->Probe(key, depth, nodes))
+        return nodes;
+
+    GenerateLegal(engine, moves);
+
+    for (const Move& move : moves)
+    {
+        engine->MakeMove(move);
+        nodes += PerftRecurse(engine, depth - 1, ply + 1, tt);
+        engine->UndoMove();
+    }
+
+    if (tt) tt->Store(key, depth, nodes);
+    return nodes;
+}
+
+uint64_t PerftCount(Engine* engine, int depth, PerftTable* tt)
+{
+    if (depth <= 0) return 1;
+    if (depth >= PERFT_MAX_DEPTH) return 0;
+    return PerftRecurse(engine, depth, 0, tt);
+}
+
+uint64_t PerftDivide(Engine* engine, int depth, PerftTable* tt)
+{
+    if (depth <= 0 || depth >= PERFT_MAX_DEPTH) return 0;
+
+    auto start = steady_clock::now();
+
+    std::vector<Move> rootMoves;
+    GenerateLegal(engine, rootMoves);
+
+    uint64_t total = 0;
+    for (const Move& move : rootMoves)
+    {
+        engine->MakeMove(move);
+        uint64_t nodes = (depth == 1) ? 1 : PerftRecurse(engine, depth - 1, 1, tt);
+        engine->UndoMove();
+
+        std::cout << MoveToUCI(move) << ": " << nodes << '\n';
+        total += nodes;
+    }
+
+    auto ms = duration_cast<milliseconds>(steady_clock::now() - start).count();
+    std::cout << "\nNodes searched: " << total << '\n';
+    std::cout << "Time (ms): " << ms << "  nps: " << (total * 1000 / (ms + 1)) << std::endl;
+    return total;
+}
+
+bool RunPerftSuite(Engine* engine, int maxDepth, PerftTable* tt)
+{
+    bool allPassed = true;
+    uint64_t totalNodes = 0;
+    auto suiteStart = steady_clock::now();
+
+    for (const PerftPosition& pos : perftPositions)
+    {
+        std::cout << pos.name << " (" << pos.fen << ")\n";
+
+        for (int depth = 1; depth <= maxDepth && depth <= 7 && pos.expected[depth - 1]; ++depth)
+        {
+            GameState::Reset();
+            engine->Init(pos.fen);
+            if (tt) tt->Clear(); // Each count stands on its own
+
+            auto start = steady_clock::now();
+            uint64_t nodes = PerftCount(engine, depth, tt);
+            auto ms = duration_cast<milliseconds>(steady_clock::now() - start).count();
+
+            bool pass = (nodes == pos.expected[depth - 1]);
+            allPassed &= pass;
+            totalNodes += nodes;
+
+            std::cout << "  depth " << depth << ": " << nodes
+                << (pass ? "  ok" : "  FAIL, expected " + std::to_string(pos.expected[depth - 1]))
+                << "  (" << ms << " ms)\n";
+        }
+    }
+
+    auto ms = duration_cast<milliseconds>(steady_clock::now() - suiteStart).count();
+    std::cout << "\n" << (allPassed ? "All perft counts match" : "Perft MISMATCH") << '\n';
+    std::cout << "Nodes: " << totalNodes << "  Time (ms): " << ms << "  nps: " << (totalNodes * 1000 / (ms + 1))
+              << "  sliders: " << Movegen::SliderLookupName() << std::endl;
+    return allPassed;
+}
+
+uint64_t PerftParallel(const std::string& fen, int depth, int threads, PerftTable* tt, bool splitSecondPly)
+{
+    if (depth <= 0 || depth >= PERFT_MAX_DEPTH) return 0;
+    if (threads < 1) threads = 1;
+
+    auto start = steady_clock::now();
+
+    // Work items are move sequences from the root, 1 move or 2 if splitting the second ply too
+    std::vector<std::vector<Move>> work;
+    std::vector<Move> rootMoves;
+    {
+        GameState::Reset();
+        Engine root(fen);
+        GenerateLegal(&root, rootMoves);
+
+        for (const Move& move : rootMoves)
+        {
+            if (!splitSecondPly || depth < 3)
+            {
+                work.push_back({ move });
+                continue;
+            }
+
+            std::vector<Move> replies;
+            root.MakeMove(move);
+            GenerateLegal(&root, replies);
+            root.UndoMove();
+
+            for (const Move& reply : replies)
+                work.push_back({ move, reply });
+        }
+    }
+
+    std::vector<uint64_t> workNodes(work.size(), 0);
+    std::vector<uint64_t> threadNodes(threads, 0);
+    std::vector<long long> threadMs(threads, 0);
+    std::atomic<size_t> nextItem{ 0 };
+
+    auto worker = [&](int id)
+    {
+        auto threadStart = steady_clock::now();
+
+        // Own copy of the position, GameState is per thread
+        GameState::Reset();
+        Engine engine(fen);
+
+        size_t item;
+        while ((item = nextItem.fetch_add(1)) < work.size())
+        {
+            const std::vector<Move>& line = work[item];
+            for (const Move& move : line)
+                engine.MakeMove(move);
+
+            int remaining = depth - (int)line.size();
+            uint64_t nodes = (remaining == 0) ? 1 : PerftRecurse(&engine, remaining, (int)line.size(), tt);
+
+            for (size_t i = 0; i < line.size(); ++i)
+                engine.UndoMove();
+
+            workNodes[item] = nodes;
+            threadNodes[id] += nodes;
+        }
+
+        threadMs[id] = duration_cast<milliseconds>(steady_clock::now() - threadStart).count();
+    };
+
+    std::vector<std::thread> pool;
+    for (int i = 0; i < threads; ++i)
+        pool.emplace_back(worker, i);
+    for (auto& t : pool)
+        t.join();
+
+    // Divide output, second ply items get added back into their root move
+    std::map<Move, uint64_t> perRoot;
+    for (const Move& move : rootMoves)
+        perRoot[move] = 0;
+    for (size_t i = 0; i < work.size(); ++i)
+        perRoot[work[i][0]] += workNodes[i];
+
+    uint64_t total = 0;
+    for (const Move& move : rootMoves)
+    {
+        std::cout << MoveToUCI(move) << ": " << perRoot[move] << '\n';
+        total += perRoot[move];
+    }
+
+    auto ms = duration_cast<milliseconds>(steady_clock::now() - start).count();
+    std::cout << '\n';
+    for (int i = 0; i < threads; ++i)
+        std::cout << "Thread " << i << ": " << threadNodes[i] << " nodes, " << threadMs[i] << " ms, "
+            << (threadNodes[i] * 1000 / (threadMs[i] + 1)) << " nps\n";
+
+    std::cout << "\nNodes searched: " << total << '\n';
+    std::cout << "Time (ms): " << ms << "  nps: " << (total * 1000 / (ms + 1)) << "  threads: " << threads << std::endl;
+    return total;
+}
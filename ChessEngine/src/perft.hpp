@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <atomic>
+#include <memory>
+
+#include "core/engine.hpp"
+
+// Perft specific hash, stores node counts for (position, depth)
+// Shared between threads without locks, key and data are stored xor'd together so a torn entry just looks like a miss
+struct PerftTable
+{
+    struct Entry
+    {
+        std::atomic<uint64_t> keyXorData;
+        std::atomic<uint64_t> data; // nodes << 8 | depth
+    };
+
+    std::unique_ptr<Entry[]> table;
+    size_t mask = 0;
+
+    PerftTable(int megabytes = 64);
+
+    bool Probe(uint64_t key, int depth, uint64_t& nodes) const;
+    void Store(uint64_t key, int depth, uint64_t nodes);
+    void Clear();
+};
+
+// Legal move count at depth, leaf moves are bulk counted instead of made
+uint64_t PerftCount(Engine* engine, int depth, PerftTable* tt = nullptr);
+
+// Prints node count for every root move ("e2e4: 20") then the total
+uint64_t PerftDivide(Engine* engine, int depth, PerftTable* tt = nullptr);
+
+// Checks the standard positions (start, Kiwipete, positions 3-6) against known counts up to maxDepth
+// Returns true if everything matched
+bool RunPerftSuite(Engine* engine, int maxDepth, PerftTable* tt = nullptr);
+
+// Splits the root (and the second ply if splitSecondPly) across threads, each with its own Engine
+// All threads share the same hash. Prints divide output and per thread node rates
+uint64_t PerftParallel(const std::string& fen, int depth, int threads, PerftTable* tt = nullptr, bool splitSecondPly = false);
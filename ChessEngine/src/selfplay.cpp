@@ -0,0 +1,354 @@
+#include "selfplay.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <random>
+#include <vector>
+#include <ctime>
+#include <cstdlib>
+
+#include "core/engine.hpp"
+#include "core/gameState.hpp"
+#include "core/movegen.hpp"
+#include "bot/bot.hpp"
+#include "bot/opening.hpp"
+#include "notation.hpp"
+#include "trainingData.hpp"
+
+using namespace std::chrono;
+
+static const char* START_FEN = "rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1";
+
+namespace
+{
+    struct GameRecord
+    {
+        std::string startFen;
+        std::vector<std::string> sanMoves;
+        std::string result;      // "1-0", "0-1", "1/2-1/2"
+        std::string termination; // Why it ended, goes in a PGN comment
+        bool adjudicated = false;
+        std::vector<PackedPosition> positions;
+    };
+
+    // Legal move matching the squares and promotion of m (book moves don't carry our flags reliably)
+    Move FindLegal(const std::vector<Move>& legal, Move m)
+    {
+        for (const Move& l : legal)
+            if (GetStart(l) == GetStart(m) && GetEnd(l) == GetEnd(m) && GetPromotion(l) == GetPromotion(m))
+                return l;
+        return Move();
+    }
+
+    // The shared book's own GetMove uses one global rng, so each game thread picks with its own
+    Move PickBookMove(Engine* engine, const std::vector<Move>& legal, std::mt19937_64& rng)
+    {
+        std::vector<BookMove> moves = GetOpeningBook().Lookup(engine->GetZobristKey());
+        int total = 0;
+        for (const BookMove& bm : moves) total += bm.weight;
+        if (total <= 0) return Move();
+
+        int r = std::uniform_int_distribution<int>(0, total - 1)(rng);
+        for (const BookMove& bm : moves)
+        {
+            if (r < bm.weight)
+                return FindLegal(legal, PolyglotToMove(bm.move, engine));
+            r -= bm.weight;
+        }
+        return Move();
+    }
+
+    std::string ToPGN(const GameRecord& game, uint64_t round, const std::string& date)
+    {
+        std::ostringstream pgn;
+        pgn << "[Event \"Self-play\"]\n"
+            << "[Site \"?\"]\n"
+            << "[Date \"" << date << "\"]\n"
+            << "[Round \"" << round << "\"]\n"
+            << "[White \"ChessEngine\"]\n"
+            << "[Black \"ChessEngine\"]\n"
+            << "[Result \"" << game.result << "\"]\n";
+        if (game.startFen != START_FEN)
+            pgn << "[FEN \"" << game.startFen << "\"]\n[SetUp \"1\"]\n";
+        pgn << "[PlyCount \"" << game.sanMoves.size() << "\"]\n\n";
+
+        std::istringstream fen(game.startFen);
+        std::string field;
+        bool blackToMove = false;
+        int fullmove = 1;
+        for (int i = 0; fen >> field; ++i)
+        {
+            if (i == 1) blackToMove = (field == "b");
+            if (i == 5) fullmove = std::max(1, std::atoi(field.c_str()));
+        }
+
+        // Movetext wrapped at 80 columns
+        std::string line;
+        auto add = [&](const std::string& token)
+        {
+            if (!line.empty() && line.size() + 1 + token.size() > 80)
+            {
+                pgn << line << '\n';
+                line.clear();
+            }
+            line += (line.empty() ? "" : " ") + token;
+        };
+
+        for (size_t i = 0; i < game.sanMoves.size(); ++i)
+        {
+            bool black = blackToMove != (i % 2 == 1);
+            if (!black) add(std::to_string(fullmove) + ".");
+            else if (i == 0) add(std::to_string(fullmove) + "...");
+            add(game.sanMoves[i]);
+            if (black) ++fullmove;
+        }
+        add("{" + game.termination + "}");
+        add(game.result);
+        pgn << line << "\n\n";
+        return pgn.str();
+    }
+}
+
+bool RunSelfPlay(const SelfPlayOptions& options, SelfPlayStats* statsOut)
+{
+    auto start = steady_clock::now();
+
+    std::vector<std::string> openings;
+    if (!options.openingsEPD.empty())
+    {
+        std::ifstream in(options.openingsEPD);
+        if (!in)
+        {
+            std::cerr << "Can't open " << options.openingsEPD << '\n';
+            return false;
+        }
+        std::string line, fen, id;
+        while (std::getline(in, line))
+            if (ParseEPDLine(line, fen, id))
+                openings.push_back(fen);
+        if (openings.empty())
+        {
+            std::cerr << "No positions in " << options.openingsEPD << '\n';
+            return false;
+        }
+    }
+
+    if (!options.bookFile.empty() && !GetOpeningBook().Open(options.bookFile))
+    {
+        std::cerr << "Can't open " << options.bookFile << '\n';
+        return false;
+    }
+    if (!GetOpeningBook().IsOpen() && openings.empty() && options.randomPlies == 0)
+        std::cerr << "No book or openings, every game will start the same\n";
+
+    std::ofstream pgnOut;
+    if (!options.pgnPath.empty())
+    {
+        pgnOut.open(options.pgnPath);
+        if (!pgnOut)
+        {
+            std::cerr << "Can't write " << options.pgnPath << '\n';
+            return false;
+        }
+    }
+
+    TrainingWriter dataOut;
+    if (!options.dataPath.empty() && !dataOut.Open(options.dataPath))
+    {
+        std::cerr << "Can't write " << options.dataPath << '\n';
+        return false;
+    }
+
+    SearchLimits limits;
+    limits.depth = options.depth;
+    limits.moveTime = options.depth > 0 ? -1 : options.moveTime;
+    limits.nodes = (options.depth > 0 || options.moveTime > 0) ? -1 : options.nodes;
+    limits.moveOverhead = 0;
+    limits.useBook = false; // Openings are picked here so every game is different
+
+    std::string date;
+    {
+        std::time_t now = std::time(nullptr);
+        char buffer[16];
+        std::strftime(buffer, sizeof(buffer), "%Y.%m.%d", std::localtime(&now));
+        date = buffer;
+    }
+
+    const uint64_t seed = options.seed ? options.seed : std::random_device{}();
+    std::atomic<int> nextGame{ 0 };
+    std::mutex outMutex;
+    SelfPlayStats stats;
+
+    auto worker = [&](int id)
+    {
+        // Own position and search per thread, GameState is thread local
+        GameState::Reset();
+        Engine engine;
+        Bot bot(&engine, Color::WHITE, options.hashMB);
+        bot.SetSilent(true);
+        std::mt19937_64 rng(seed + 0x9E3779B97F4A7C15ull * (id + 1));
+
+        int gameIndex;
+        while ((gameIndex = nextGame.fetch_add(1)) < options.games)
+        {
+            GameRecord game;
+            game.startFen = openings.empty() ? START_FEN : openings[rng() % openings.size()];
+
+            GameState::Reset();
+            engine.Init(game.startFen);
+            bot.Clear();
+
+            int startFullmove = 1;
+            {
+                std::istringstream fen(game.startFen);
+                std::string field;
+                for (int i = 0; fen >> field; ++i)
+                    if (i == 5) startFullmove = std::max(1, std::atoi(field.c_str()));
+            }
+            const bool startBlack = !IsWhite(GameState::currentPlayer);
+
+            int ply = 0;
+            int winStreak[2] = { 0, 0 }; // Plies in a row white/black has been winning by resignScore
+            int drawStreak = 0;
+            bool failed = false;
+
+            auto play = [&](Move move)
+            {
+                game.sanMoves.push_back(MoveToSAN(move, &engine));
+                engine.MakeMove(move);
+                ++ply;
+            };
+
+            // Opening: book moves then random ones
+            for (int i = 0; i < options.bookPlies + options.randomPlies; ++i)
+            {
+                std::vector<Move> legal = Movegen::GetAllLegalMoves(GameState::currentPlayer, engine.GetBitboardBoard(), &engine);
+                if (legal.empty()) break;
+
+                Move move = Move();
+                if (i < options.bookPlies)
+                    move = PickBookMove(&engine, legal, rng);
+                else
+                    move = legal[rng() % legal.size()];
+                if (MoveIsNull(move)) continue; // Out of book, go on with random moves
+                play(move);
+            }
+
+            while (true)
+            {
+                Color us = GameState::currentPlayer;
+                bool inCheck = engine.InCheck(us); // Tells mate from stalemate when there are no legal moves
+
+                if (engine.IsDraw())
+                {
+                    game.result = "1/2-1/2";
+                    game.termination = engine.IsThreefold() ? "Threefold repetition" : "50 move rule";
+                    break;
+                }
+
+                std::vector<Move> legal = Movegen::GetAllLegalMoves(us, engine.GetBitboardBoard(), &engine);
+                if (legal.empty())
+                {
+                    game.result = !inCheck ? "1/2-1/2" : (IsWhite(us) ? "0-1" : "1-0");
+                    game.termination = inCheck ? "Checkmate" : "Stalemate";
+                    break;
+                }
+                if (ply >= options.maxPlies)
+                {
+                    game.result = "1/2-1/2";
+                    game.termination = "Max plies";
+                    game.adjudicated = true;
+                    break;
+                }
+
+                Move move;
+                int score;
+                try
+                {
+                    bot.SetColor(us);
+                    move = bot.GetMoveUCI(limits);
+                    score = bot.GetLastScore();
+                }
+                catch (const char*)
+                {
+                    failed = true;
+                    break;
+                }
+
+                int whiteScore = IsWhite(us) ? score : -score;
+                int fullmove = startFullmove + (ply + (startBlack ? 1 : 0)) / 2;
+                game.positions.push_back(PackPosition(&engine, whiteScore, fullmove));
+
+                // Adjudication
+                winStreak[0] = whiteScore >= options.resignScore ? winStreak[0] + 1 : 0;
+                winStreak[1] = whiteScore <= -options.resignScore ? winStreak[1] + 1 : 0;
+                drawStreak = (ply >= options.drawMinPly && std::abs(whiteScore) <= options.drawScore) ? drawStreak + 1 : 0;
+
+                play(move);
+
+                if (options.resignMoves > 0 && (winStreak[0] >= options.resignMoves || winStreak[1] >= options.resignMoves))
+                {
+                    game.result = winStreak[0] >= options.resignMoves ? "1-0" : "0-1";
+                    game.termination = std::string(winStreak[0] >= options.resignMoves ? "Black" : "White") + " resigns";
+                    game.adjudicated = true;
+                    break;
+                }
+                if (options.drawMoves > 0 && drawStreak >= options.drawMoves)
+                {
+                    game.result = "1/2-1/2";
+                    game.termination = "Draw agreed";
+                    game.adjudicated = true;
+                    break;
+                }
+            }
+
+            if (failed)
+            {
+                std::lock_guard<std::mutex> lock(outMutex);
+                ++stats.errors;
+                std::cerr << "Game " << gameIndex + 1 << " dropped, search failed\n";
+                continue;
+            }
+
+            uint8_t result = game.result == "1-0" ? 2 : (game.result == "0-1" ? 0 : 1);
+            for (PackedPosition& pos : game.positions)
+                pos.result = result;
+            dataOut.Write(game.positions);
+
+            std::lock_guard<std::mutex> lock(outMutex);
+            ++stats.games;
+            if (result == 2) ++stats.whiteWins;
+            else if (result == 0) ++stats.blackWins;
+            else ++stats.draws;
+            if (game.adjudicated) ++stats.adjudicated;
+            stats.positions += game.positions.size();
+
+            if (pgnOut.is_open())
+                pgnOut << ToPGN(game, stats.games, date) << std::flush;
+
+            std::cerr << "Game " << stats.games << '/' << options.games << ": " << game.result << " (" << game.termination
+                      << ", " << ply << " plies)  +" << stats.whiteWins << " =" << stats.draws << " -" << stats.blackWins << '\n';
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t < std::max(1, options.threads); ++t)
+        pool.emplace_back(worker, t);
+    for (std::thread& t : pool)
+        t.join();
+
+    dataOut.Close();
+
+    stats.timeMs = duration_cast<milliseconds>(steady_clock::now() - start).count();
+    std::cerr << "Games: " << stats.games << "  white: " << stats.whiteWins << "  draws: " << stats.draws << "  black: " << stats.blackWins
+              << "  adjudicated: " << stats.adjudicated << "  dropped: " << stats.errors << "  positions: " << stats.positions
+              << "  time (ms): " << stats.timeMs << '\n';
+
+    if (statsOut) *statsOut = stats;
+    return true;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+struct SelfPlayOptions
+{
+    int games = 100;
+    int threads = 1;          // Independent games running at once, each thread has its own Engine and Bot
+
+    // Per move limits, the first one given is used
+    int depth = -1;
+    int moveTime = -1;
+    long long nodes = 5000;
+    int hashMB = 16;          // Per thread
+
+    // Openings: a random line of openingsEPD if given, then weighted random book moves, then uniformly random moves
+    std::string openingsEPD;
+    std::string bookFile;     // Polyglot book, the shared one (res/openings.bin / UCI Book File) if empty
+    int bookPlies = 8;
+    int randomPlies = 0;
+
+    // Adjudication, scores are in cp from the side to move's search
+    int resignScore = 1000;   // Over this for resignMoves plies in a row, the losing side resigns
+    int resignMoves = 6;
+    int drawScore = 10;       // Under this for drawMoves plies in a row after drawMinPly, agreed draw
+    int drawMoves = 10;
+    int drawMinPly = 80;
+    int maxPlies = 400;       // Called a draw after this many plies
+
+    std::string pgnPath;      // Games go here if set
+    std::string dataPath;     // Searched positions as PackedPosition records if set
+    uint64_t seed = 0;        // 0 picks a random seed
+};
+
+struct SelfPlayStats
+{
+    uint64_t games = 0;
+    uint64_t whiteWins = 0, blackWins = 0, draws = 0;
+    uint64_t adjudicated = 0;
+    uint64_t errors = 0;      // Games dropped because the search threw
+    uint64_t positions = 0;   // Training records written
+    long long timeMs = 0;
+};
+
+// Plays games bot against bot without a window on a pool of threads until options.games are done
+// Returns false if an output or opening file couldn't be opened
+bool RunSelfPlay(const SelfPlayOptions& options, SelfPlayStats* stats = nullptr);
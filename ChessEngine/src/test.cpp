@@ -11,6 +11,11 @@
 #include "core/engine.hpp"
 #include "core/movegen.hpp"
 
+#if !defined(_WIN32)
+#define _popen popen
+#define _pclose pclose
+#endif
+
 StockfishPerftResult StockfishPerft(const std::string& stockfishPath, const std::string& fen, int depth)
 {
     const char* tmpFilename = "stockfish_uci_commands.txt";
@@ -10,7 +10,7 @@
 struct StockfishPerftResult
 {
     long long nodes;
-    std::map<std::string, unsigned long long> moves; // UCI moves at the root
+    std::map<std::string, uint64_t> moves; // UCI moves at the root
 };
 
 struct TmpFileGuard
@@ -0,0 +1,290 @@
+#include "trainingData.hpp"
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <cstdlib>
+#include <cctype>
+#include <cstring>
+
+#include "core/gameState.hpp"
+#include "core/boardCalculator.hpp"
+#include "notation.hpp"
+
+static const char PIECE_CHARS[] = " pnbrqk";
+static const char* RESULTS[] = { "0-1", "1/2-1/2", "1-0" };
+
+PackedPosition PackPosition(Engine* engine, int whiteScore, int fullmove)
+{
+    PackedPosition pos = {};
+    const BitboardBoard& board = engine->GetBitboardBoard();
+    pos.occupancy = board.occupied;
+
+    Bitboard occupied = board.occupied;
+    for (int i = 0; occupied; ++i)
+    {
+        int sq = PopLSB(occupied);
+        Piece piece = engine->GetBoard()[sq].GetPiece();
+        uint8_t nibble = (uint8_t)(((piece.GetColor() == Color::BLACK ? 1 : 0) << 3) | (int)piece.GetType());
+        pos.pieces[i / 2] |= (i & 1) ? (nibble << 4) : nibble;
+    }
+
+    pos.score = (int16_t)std::clamp(whiteScore, -PACKED_MATE_SCORE, PACKED_MATE_SCORE);
+    pos.result = 1;
+
+    pos.flags = IsWhite(GameState::currentPlayer) ? 0 : 1;
+    if (GameState::whiteCastlingRights[1]) pos.flags |= 1 << 1;
+    if (GameState::whiteCastlingRights[0]) pos.flags |= 1 << 2;
+    if (GameState::blackCastlingRights[1]) pos.flags |= 1 << 3;
+    if (GameState::blackCastlingRights[0]) pos.flags |= 1 << 4;
+
+    pos.enPassant = GameState::enPassantTarget > 0 ? (uint8_t)GameState::enPassantTarget : 0;
+    pos.halfmoves = (uint8_t)std::min(GameState::halfmoves, 255);
+    pos.fullmove = (uint16_t)std::clamp(fullmove, 1, 65535);
+    return pos;
+}
+
+bool PackFEN(const std::string& fen, int whiteScore, uint8_t result, PackedPosition& pos)
+{
+    pos = {};
+    std::istringstream iss(fen);
+    std::string board, side, castling = "-", enPassant = "-";
+    int halfmoves = 0, fullmove = 1;
+    if (!(iss >> board >> side)) return false;
+    iss >> castling >> enPassant >> halfmoves >> fullmove;
+
+    int row = 0, col = 0, count = 0;
+    for (char c : board)
+    {
+        if (c == '/')
+        {
+            if (col != 8 || ++row > 7) return false;
+            col = 0;
+        }
+        else if (c >= '1' && c <= '8')
+            col += c - '0';
+        else
+        {
+            const char* type = std::strchr(PIECE_CHARS + 1, std::tolower((unsigned char)c));
+            if (!type || col > 7 || count == 32) return false;
+            int sq = ToIndex(row, col++);
+            uint8_t nibble = (uint8_t)((std::isupper((unsigned char)c) ? 0 : 1) << 3 | (int)(type - PIECE_CHARS));
+            pos.occupancy |= 1ull << sq;
+            pos.pieces[count / 2] |= (count & 1) ? (nibble << 4) : nibble; // FEN goes a8..h1, already bit order
+            ++count;
+        }
+        if (col > 8) return false;
+    }
+    if (row != 7 || col != 8) return false;
+    if (side != "w" && side != "b") return false;
+
+    pos.flags = side == "b" ? 1 : 0;
+    for (char c : castling)
+    {
+        const char* right = std::strchr("KQkq", c);
+        if (c && right) pos.flags |= 1 << (1 + (right - "KQkq"));
+    }
+    if (enPassant.size() == 2 && enPassant[0] >= 'a' && enPassant[0] <= 'h' && enPassant[1] >= '1' && enPassant[1] <= '8')
+        pos.enPassant = (uint8_t)ToIndex('8' - enPassant[1], enPassant[0] - 'a');
+
+    pos.score = (int16_t)std::clamp(whiteScore, -PACKED_MATE_SCORE, PACKED_MATE_SCORE);
+    pos.result = std::min<uint8_t>(result, 2);
+    pos.halfmoves = (uint8_t)std::clamp(halfmoves, 0, 255);
+    pos.fullmove = (uint16_t)std::clamp(fullmove, 1, 65535);
+    return true;
+}
+
+std::string UnpackToFEN(const PackedPosition& pos)
+{
+    char squares[64] = {};
+    Bitboard occupied = pos.occupancy;
+    for (int i = 0; occupied; ++i)
+    {
+        int sq = PopLSB(occupied);
+        uint8_t nibble = (pos.pieces[i / 2] >> ((i & 1) * 4)) & 0xF;
+        char c = PIECE_CHARS[std::min(nibble & 7, 6)];
+        squares[sq] = (nibble & 8) ? c : (char)std::toupper(c);
+    }
+
+    std::string fen;
+    for (int row = 0; row < 8; ++row)
+    {
+        int empty = 0;
+        for (int col = 0; col < 8; ++col)
+        {
+            char c = squares[ToIndex(row, col)];
+            if (!c) { ++empty; continue; }
+            if (empty) fen += (char)('0' + empty);
+            empty = 0;
+            fen += c;
+        }
+        if (empty) fen += (char)('0' + empty);
+        if (row < 7) fen += '/';
+    }
+
+    fen += (pos.flags & 1) ? " b " : " w ";
+    std::string castling;
+    for (int i = 0; i < 4; ++i)
+        if (pos.flags & (1 << (1 + i))) castling += "KQkq"[i];
+    fen += castling.empty() ? "-" : castling;
+
+    if (pos.enPassant)
+    {
+        fen += ' ';
+        fen += (char)('a' + ToCol(pos.enPassant));
+        fen += (char)('8' - ToRow(pos.enPassant));
+    }
+    else fen += " -";
+
+    fen += " " + std::to_string(pos.halfmoves) + " " + std::to_string(pos.fullmove);
+    return fen;
+}
+
+bool TrainingReader::Open(const std::string& path)
+{
+    Close();
+    if (!file.Open(path, MappedFile::Access::SEQUENTIAL)) return false;
+
+    count = file.Size() / sizeof(PackedPosition);
+    if (count == 0)
+    {
+        file.Close();
+        return false;
+    }
+    records = reinterpret_cast<const PackedPosition*>(file.Data()); // Mappings are page aligned, the fallback buffer comes from new
+    return true;
+}
+
+void TrainingReader::Close()
+{
+    file.Close();
+    records = nullptr;
+    count = 0;
+}
+
+// Game result from `c9 "1-0";`, `[1.0]`/`[0.5]`/`[0.0]` or a bare result anywhere after the position, -1 if there's none
+static int ParseResult(const std::string& operations)
+{
+    std::string value;
+    if (FindEPDOpcode(operations, "c9", value) || FindEPDOpcode(operations, "c1", value))
+        for (int r = 0; r < 3; ++r)
+            if (value == RESULTS[r]) return r;
+
+    const char* bracketed[] = { "[0.0]", "[0.5]", "[1.0]" };
+    for (int r = 0; r < 3; ++r)
+        if (operations.find(bracketed[r]) != std::string::npos) return r;
+    for (int r : { 1, 2, 0 }) // 1/2-1/2 first, it has "1-" and "-1" in it
+        if (operations.find(RESULTS[r]) != std::string::npos) return r;
+    return -1;
+}
+
+bool ConvertEPDToTraining(const std::string& epdPath, const std::string& binPath, uint64_t* written)
+{
+    std::ifstream in(epdPath);
+    if (!in)
+    {
+        std::cerr << "Can't open " << epdPath << '\n';
+        return false;
+    }
+    TrainingWriter out;
+    if (!out.Open(binPath))
+    {
+        std::cerr << "Can't write " << binPath << '\n';
+        return false;
+    }
+
+    std::vector<PackedPosition> batch;
+    batch.reserve(4096);
+    std::string line, fen, id;
+    uint64_t lineNumber = 0, skipped = 0;
+    while (std::getline(in, line))
+    {
+        ++lineNumber;
+        if (line.find_first_not_of(" \t\r") == std::string::npos || line[0] == '#') continue;
+
+        // Operations are whatever follows the four position fields
+        std::istringstream fields(line);
+        std::string field, operations;
+        for (int i = 0; i < 4; ++i) fields >> field;
+        std::getline(fields, operations);
+
+        PackedPosition pos;
+        int result = ParseResult(operations);
+        if (!ParseEPDLine(line, fen, id) || result < 0 || !PackFEN(fen, 0, (uint8_t)result, pos))
+        {
+            if (++skipped <= 10) std::cerr << "Skipping line " << lineNumber << ": no position or result\n";
+            continue;
+        }
+
+        std::string ce;
+        if (FindEPDOpcode(operations, "ce", ce))
+        {
+            int score = std::atoi(ce.c_str());
+            pos.score = (int16_t)std::clamp((pos.flags & 1) ? -score : score, -PACKED_MATE_SCORE, PACKED_MATE_SCORE);
+        }
+
+        batch.push_back(pos);
+        if (batch.size() == batch.capacity())
+        {
+            out.Write(batch);
+            batch.clear();
+        }
+    }
+    out.Write(batch);
+    out.Close();
+
+    std::cerr << "Positions: " << out.Count() << "  skipped: " << skipped << '\n';
+    if (written) *written = out.Count();
+    return true;
+}
+
+bool ConvertTrainingToEPD(const std::string& binPath, const std::string& epdPath, uint64_t* written)
+{
+    TrainingReader in;
+    if (!in.Open(binPath))
+    {
+        std::cerr << "Can't open " << binPath << '\n';
+        return false;
+    }
+    std::ofstream out(epdPath);
+    if (!out)
+    {
+        std::cerr << "Can't write " << epdPath << '\n';
+        return false;
+    }
+
+    for (const PackedPosition& pos : in)
+    {
+        std::string fen = UnpackToFEN(pos);
+        size_t clocks = fen.find(' ', fen.find(' ', fen.find(' ', fen.find(' ') + 1) + 1) + 1); // After the ep field
+        out << fen.substr(0, clocks) << " hmvc " << (int)pos.halfmoves << "; fmvn " << pos.fullmove
+            << "; ce " << ((pos.flags & 1) ? -pos.score : pos.score) << "; c9 \"" << RESULTS[std::min<int>(pos.result, 2)] << "\";\n";
+    }
+
+    std::cerr << "Positions: " << in.Size() << '\n';
+    if (written) *written = in.Size();
+    return (bool)out;
+}
+
+bool TrainingWriter::Open(const std::string& path, bool append)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    out.open(path, std::ios::binary | (append ? std::ios::app : std::ios::trunc));
+    count = 0;
+    return out.is_open();
+}
+
+void TrainingWriter::Write(const std::vector<PackedPosition>& positions)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!out.is_open() || positions.empty()) return;
+
+    out.write(reinterpret_cast<const char*>(positions.data()), (std::streamsize)(positions.size() * sizeof(PackedPosition)));
+    count += positions.size();
+}
+
+void TrainingWriter::Close()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    if (out.is_open()) out.close();
+}
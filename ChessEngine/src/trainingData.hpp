@@ -0,0 +1,76 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <fstream>
+#include <mutex>
+
+#include "core/engine.hpp"
+#include "core/mappedFile.hpp"
+
+// One labeled position, 32 bytes on disk. Files are just these back to back (little endian)
+struct PackedPosition
+{
+    uint64_t occupancy;   // Same square order as our bitboards (a8 = bit 0)
+    uint8_t pieces[16];   // 4 bits per occupied square in bit order, low nibble first: color << 3 | type (PAWN = 1 ... KING = 6)
+    int16_t score;        // Search score in cp from white's side, mates clamped to +-PACKED_MATE_SCORE
+    uint8_t result;       // 0 black won, 1 draw, 2 white won
+    uint8_t flags;        // Bit 0 black to move, bits 1-4 castling KQkq
+    uint8_t enPassant;    // Ep square, 0 if none (a8 can't be one)
+    uint8_t halfmoves;
+    uint16_t fullmove;
+};
+static_assert(sizeof(PackedPosition) == 32, "Training records are written as raw 32 byte structs");
+
+constexpr int PACKED_MATE_SCORE = 32000;
+
+// Result is left as a draw, it's only known once the game is over
+PackedPosition PackPosition(Engine* engine, int whiteScore, int fullmove);
+
+// Straight from a FEN without setting up an Engine, false if the FEN is malformed
+bool PackFEN(const std::string& fen, int whiteScore, uint8_t result, PackedPosition& pos);
+std::string UnpackToFEN(const PackedPosition& pos);
+
+// Appends records to a file, safe to share between threads (every Write lands as one block)
+class TrainingWriter
+{
+public:
+    bool Open(const std::string& path, bool append = false);
+    void Write(const std::vector<PackedPosition>& positions);
+    void Close();
+    bool IsOpen() const { return out.is_open(); }
+    uint64_t Count() const { return count; }
+
+private:
+    std::ofstream out;
+    std::mutex mutex;
+    uint64_t count = 0;
+};
+
+// Zero copy view of a training file, records are used straight out of the mapping
+// A partial record at the end (run killed mid write) is ignored
+class TrainingReader
+{
+public:
+    bool Open(const std::string& path);
+    void Close();
+    bool IsOpen() const { return records != nullptr; }
+    size_t Size() const { return count; }
+
+    const PackedPosition& operator[](size_t i) const { return records[i]; }
+    const PackedPosition* begin() const { return records; }
+    const PackedPosition* end() const { return records + count; }
+
+private:
+    MappedFile file;
+    const PackedPosition* records = nullptr;
+    size_t count = 0;
+};
+
+// EPD/FEN lines with a result (c9 "1-0"; or [1.0] style) and optionally a ce score, lines without a result are skipped
+// Returns false if a file couldn't be opened
+bool ConvertEPDToTraining(const std::string& epdPath, const std::string& binPath, uint64_t* written = nullptr);
+
+// Every record as `<fen4> hmvc; fmvn; ce; c9;`, ce is from the side to move like EPD wants
+bool ConvertTrainingToEPD(const std::string& binPath, const std::string& epdPath, uint64_t* written = nullptr);
@@ -0,0 +1,358 @@
+#include "tuner.hpp"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <random>
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+
+#include "core/engine.hpp"
+#include "core/eval.hpp"
+#include "core/gameState.hpp"
+#include "trainingData.hpp"
+
+using namespace std::chrono;
+
+namespace
+{
+    struct WeightGroup
+    {
+        const char* name;
+        size_t first; // Index into the flat int array
+        int count;
+    };
+
+    // Layout of EvalWeights, for writing it back out
+    const WeightGroup GROUPS[] = {
+        { "pieceValues",      offsetof(EvalWeights, pieceValues) / sizeof(int),      7 },
+        { "Pawns",            offsetof(EvalWeights, pawnPST) / sizeof(int),          64 },
+        { "Knights",          offsetof(EvalWeights, knightPST) / sizeof(int),        64 },
+        { "Bishops",          offsetof(EvalWeights, bishopPST) / sizeof(int),        64 },
+        { "Rooks",            offsetof(EvalWeights, rookPST) / sizeof(int),          64 },
+        { "Queens",           offsetof(EvalWeights, queenPST) / sizeof(int),         64 },
+        { "King, middle game", offsetof(EvalWeights, kingPST_mg) / sizeof(int),      64 },
+        { "King, endgame",    offsetof(EvalWeights, kingPST_eg) / sizeof(int),       64 },
+        { "doubledPenalty",   offsetof(EvalWeights, doubledPenalty) / sizeof(int),   1 },
+        { "isolatedPenalty",  offsetof(EvalWeights, isolatedPenalty) / sizeof(int),  1 },
+        { "passedBonus",      offsetof(EvalWeights, passedBonus) / sizeof(int),      1 },
+        { "bishopPair",       offsetof(EvalWeights, bishopPair) / sizeof(int),       1 },
+        { "rookOpenFile",     offsetof(EvalWeights, rookOpenFile) / sizeof(int),     1 },
+        { "rookSemiOpenFile", offsetof(EvalWeights, rookSemiOpenFile) / sizeof(int), 1 },
+        { "rookSameFile",     offsetof(EvalWeights, rookSameFile) / sizeof(int),     1 },
+        { "rookSeventh",      offsetof(EvalWeights, rookSeventh) / sizeof(int),      1 },
+        { "knightMobility",   offsetof(EvalWeights, knightMobility) / sizeof(int),   1 },
+        { "bishopMobility",   offsetof(EvalWeights, bishopMobility) / sizeof(int),   1 },
+        { "rookMobility",     offsetof(EvalWeights, rookMobility) / sizeof(int),     1 },
+        { "queenMobility",    offsetof(EvalWeights, queenMobility) / sizeof(int),    1 },
+        { "kingZoneAttack",   offsetof(EvalWeights, kingZoneAttack) / sizeof(int),   1 },
+    };
+
+    struct Coefficient
+    {
+        uint16_t index;
+        int16_t value;
+    };
+
+    // Every position as base + sum(weight * coefficient) over the tuned weights, struct of arrays so the
+    // per position passes below run over contiguous floats
+    struct DataSet
+    {
+        std::vector<uint64_t> offsets;          // Position i's coefficients are [offsets[i], offsets[i + 1])
+        std::vector<Coefficient> coefficients;
+        std::vector<float> base;                // Eval part coming from weights that aren't tuned
+        std::vector<float> result;              // 0, 0.5, 1 from white's side
+        std::vector<float> score;               // Stored search score, white's side
+        std::vector<float> target;
+
+        size_t Size() const { return base.size(); }
+    };
+
+    const int* Flat(const EvalWeights& w) { return reinterpret_cast<const int*>(&w); }
+
+    // Runs fn(begin, end, thread) over [0, count) split across the threads, returns how many were used
+    template<typename Fn>
+    int Parallel(size_t count, int threads, Fn fn)
+    {
+        threads = std::max(1, std::min<int>(threads, (int)std::max<size_t>(1, count / 1024)));
+        std::vector<std::thread> pool;
+        for (int t = 0; t < threads; ++t)
+            pool.emplace_back(fn, count * t / threads, count * (t + 1) / threads, t);
+        for (std::thread& thread : pool)
+            thread.join();
+        return threads;
+    }
+
+    bool Load(const TrainingReader& reader, const std::vector<bool>& tuned, int threads, DataSet& data)
+    {
+        std::vector<size_t> order(reader.Size());
+        for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+        std::shuffle(order.begin(), order.end(), std::mt19937_64(0)); // Mini batches shouldn't be all one game
+
+        // Each thread extracts its slice, then they're stitched together in order
+        std::vector<DataSet> parts(std::max(1, threads));
+        const int* weights = Flat(evalWeights);
+        Parallel(order.size(), threads, [&](size_t begin, size_t end, int t)
+        {
+            GameState::Reset();
+            Engine engine;
+            DataSet& part = parts[t];
+            auto trace = std::make_unique<EvalTrace>();
+            const int* coefficients = trace->coefficients;
+
+            for (size_t i = begin; i < end; ++i)
+            {
+                const PackedPosition& pos = reader[order[i]];
+                GameState::Reset();
+                engine.Init(UnpackToFEN(pos));
+
+                // Assumes the default 1.0 eval scale, so evalWeights are the defaults and eval is the plain dot product
+                int eval = EvalWithTrace(&engine, *trace);
+                int rest = eval;
+                part.offsets.push_back(part.coefficients.size());
+                for (int w = 0; w < EVAL_WEIGHT_COUNT; ++w)
+                {
+                    if (!coefficients[w] || !tuned[w]) continue;
+                    part.coefficients.push_back({ (uint16_t)w, (int16_t)coefficients[w] });
+                    rest -= weights[w] * coefficients[w];
+                }
+                part.base.push_back((float)rest);
+                part.result.push_back(pos.result * 0.5f);
+                part.score.push_back(pos.score);
+            }
+        });
+
+        for (DataSet& part : parts)
+        {
+            uint64_t shift = data.coefficients.size();
+            for (uint64_t offset : part.offsets) data.offsets.push_back(offset + shift);
+            data.coefficients.insert(data.coefficients.end(), part.coefficients.begin(), part.coefficients.end());
+            data.base.insert(data.base.end(), part.base.begin(), part.base.end());
+            data.result.insert(data.result.end(), part.result.begin(), part.result.end());
+            data.score.insert(data.score.end(), part.score.begin(), part.score.end());
+            part = DataSet();
+        }
+        data.offsets.push_back(data.coefficients.size());
+        return data.Size() > 0;
+    }
+
+    // Texel's 1 / (1 + 10^(-k * eval / 400)), as exp so the loops can vectorize
+    inline float Sigmoid(float eval, float scale) { return 1.0f / (1.0f + std::exp(-scale * eval)); }
+    inline float Scale(double k) { return (float)(k * std::log(10.0) / 400.0); }
+
+    void Evaluate(const DataSet& data, const std::vector<double>& weights, size_t begin, size_t end, float* evals)
+    {
+        for (size_t i = begin; i < end; ++i)
+        {
+            double eval = data.base[i];
+            for (uint64_t c = data.offsets[i]; c < data.offsets[i + 1]; ++c)
+                eval += weights[data.coefficients[c].index] * data.coefficients[c].value;
+            evals[i - begin] = (float)eval;
+        }
+    }
+
+    double Error(const DataSet& data, const std::vector<double>& weights, const std::vector<float>& targets, float scale, int threads)
+    {
+        std::vector<double> sums(std::max(1, threads), 0.0);
+        Parallel(data.Size(), threads, [&](size_t begin, size_t end, int t)
+        {
+            std::vector<float> evals(end - begin);
+            Evaluate(data, weights, begin, end, evals.data());
+            double sum = 0;
+            for (size_t i = begin; i < end; ++i)
+            {
+                double diff = Sigmoid(evals[i - begin], scale) - targets[i];
+                sum += diff * diff;
+            }
+            sums[t] = sum;
+        });
+        double total = 0;
+        for (double s : sums) total += s;
+        return total / data.Size();
+    }
+
+    // Coarse to fine search for the k that fits the untouched weights best
+    double FitK(const DataSet& data, const std::vector<double>& weights, int threads)
+    {
+        double best = 1.0, step = 1.0;
+        double bestError = Error(data, weights, data.result, Scale(best), threads);
+        for (int round = 0; round < 6; ++round)
+        {
+            double center = best;
+            for (int i = -5; i <= 5; ++i)
+            {
+                double k = center + i * step;
+                if (k <= 0) continue;
+                double error = Error(data, weights, data.result, Scale(k), threads);
+                if (error < bestError)
+                {
+                    bestError = error;
+                    best = k;
+                }
+            }
+            step /= 10;
+        }
+        return best;
+    }
+
+    void Write(const std::string& path, const std::vector<double>& weights, double k, double error)
+    {
+        std::ofstream out(path);
+        if (!out)
+        {
+            std::cerr << "Can't write " << path << '\n';
+            return;
+        }
+
+        out << "// Tuned, k " << k << ", error " << std::setprecision(8) << error << "\n";
+        out << "constexpr EvalWeights DEFAULT_EVAL_WEIGHTS = {\n";
+        for (const WeightGroup& group : GROUPS)
+        {
+            auto value = [&](int i) { return (int)std::lround(weights[group.first + i]); };
+            if (group.count == 64)
+            {
+                out << "\n\t// " << group.name << "\n\t{\n";
+                for (int row = 0; row < 8; ++row)
+                {
+                    out << "\t\t";
+                    for (int col = 0; col < 8; ++col)
+                        out << std::setw(4) << value(row * 8 + col) << (row * 8 + col < 63 ? "," : "");
+                    out << '\n';
+                }
+                out << "\t},\n";
+            }
+            else if (group.count > 1)
+            {
+                out << "\t{ ";
+                for (int i = 0; i < group.count; ++i)
+                    out << value(i) << (i + 1 < group.count ? ", " : " ");
+                out << "},\n";
+            }
+            else
+            {
+                if (group.first == offsetof(EvalWeights, doubledPenalty) / sizeof(int)) out << '\n';
+                out << '\t' << value(0) << ", // " << group.name << '\n';
+            }
+        }
+        out << "};\n";
+    }
+}
+
+bool RunTuner(const std::string& dataPath, const TunerOptions& options, TunerStats* statsOut)
+{
+    auto start = steady_clock::now();
+    const int threads = std::max(1, options.threads);
+
+    TrainingReader reader;
+    if (!reader.Open(dataPath))
+    {
+        std::cerr << "Can't open " << dataPath << '\n';
+        return false;
+    }
+
+    // The king's value cancels out and index 0 is Pieces::NONE, neither is worth tuning
+    std::vector<bool> tuned(EVAL_WEIGHT_COUNT, true);
+    for (int piece = 0; piece < 7; ++piece)
+        if (!options.tuneMaterial || piece == 0 || piece == (int)Pieces::KING)
+            tuned[offsetof(EvalWeights, pieceValues) / sizeof(int) + piece] = false;
+
+    DataSet data;
+    if (!Load(reader, tuned, threads, data))
+    {
+        std::cerr << "No positions in " << dataPath << '\n';
+        return false;
+    }
+    reader.Close();
+
+    std::vector<double> weights(Flat(evalWeights), Flat(evalWeights) + EVAL_WEIGHT_COUNT);
+    TunerStats stats;
+    stats.positions = data.Size();
+    stats.k = options.k > 0 ? options.k : FitK(data, weights, threads);
+    const float scale = Scale(stats.k);
+
+    data.target.resize(data.Size());
+    for (size_t i = 0; i < data.Size(); ++i)
+        data.target[i] = (float)(options.lambda * data.result[i] + (1 - options.lambda) * Sigmoid(data.score[i], scale));
+
+    stats.startError = stats.endError = Error(data, weights, data.target, scale, threads);
+    std::cerr << "Positions: " << stats.positions << "  coefficients: " << data.coefficients.size()
+              << "  k: " << stats.k << "  error: " << std::setprecision(8) << stats.startError << std::setprecision(6)
+              << "  load (ms): " << duration_cast<milliseconds>(steady_clock::now() - start).count() << '\n';
+
+    // Adam
+    const double beta1 = 0.9, beta2 = 0.999, epsilon = 1e-8;
+    std::vector<double> m(EVAL_WEIGHT_COUNT, 0.0), v(EVAL_WEIGHT_COUNT, 0.0);
+    std::vector<std::vector<double>> gradients(threads, std::vector<double>(EVAL_WEIGHT_COUNT));
+    const size_t batchSize = options.batchSize > 0 ? std::min<size_t>(options.batchSize, data.Size()) : data.Size();
+    uint64_t step = 0;
+
+    for (int epoch = 1; epoch <= options.epochs; ++epoch)
+    {
+        for (size_t batch = 0; batch < data.Size(); batch += batchSize)
+        {
+            size_t batchEnd = std::min(batch + batchSize, data.Size());
+
+            // Evals into a flat array, then the sigmoid/error part over it (the vectorizable bit),
+            // then scattered into this thread's gradient
+            int used = Parallel(batchEnd - batch, threads, [&](size_t begin, size_t end, int t)
+            {
+                begin += batch;
+                end += batch;
+                std::vector<float> evals(end - begin);
+                Evaluate(data, weights, begin, end, evals.data());
+
+                const float* target = data.target.data() + begin;
+                for (size_t i = 0; i < evals.size(); ++i)
+                {
+                    float s = Sigmoid(evals[i], scale);
+                    evals[i] = (s - target[i]) * s * (1 - s);
+                }
+
+                std::vector<double>& gradient = gradients[t];
+                std::fill(gradient.begin(), gradient.end(), 0.0);
+                for (size_t i = begin; i < end; ++i)
+                    for (uint64_t c = data.offsets[i]; c < data.offsets[i + 1]; ++c)
+                        gradient[data.coefficients[c].index] += evals[i - begin] * data.coefficients[c].value;
+            });
+
+            ++step;
+            const double norm = 2.0 * scale / (batchEnd - batch);
+            for (int w = 0; w < EVAL_WEIGHT_COUNT; ++w)
+            {
+                if (!tuned[w]) continue;
+                double g = 0;
+                for (int t = 0; t < used; ++t) g += gradients[t][w];
+                g *= norm;
+
+                m[w] = beta1 * m[w] + (1 - beta1) * g;
+                v[w] = beta2 * v[w] + (1 - beta2) * g * g;
+                double mHat = m[w] / (1 - std::pow(beta1, (double)step));
+                double vHat = v[w] / (1 - std::pow(beta2, (double)step));
+                weights[w] -= options.learningRate * mHat / (std::sqrt(vHat) + epsilon);
+            }
+        }
+
+        if (epoch % std::max(1, options.reportEvery) == 0 || epoch == options.epochs)
+        {
+            stats.endError = Error(data, weights, data.target, scale, threads);
+            std::cerr << "Epoch " << epoch << "  error: " << std::setprecision(8) << stats.endError << std::setprecision(6)
+                      << "  time (ms): " << duration_cast<milliseconds>(steady_clock::now() - start).count() << '\n';
+            Write(options.outPath, weights, stats.k, stats.endError);
+        }
+    }
+    if (options.epochs <= 0)
+        Write(options.outPath, weights, stats.k, stats.endError);
+
+    stats.timeMs = duration_cast<milliseconds>(steady_clock::now() - start).count();
+    std::cerr << "Error " << std::setprecision(8) << stats.startError << " -> " << stats.endError << std::setprecision(6)
+              << ", weights written to " << options.outPath << '\n';
+
+    if (statsOut) *statsOut = stats;
+    return true;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+struct TunerOptions
+{
+    int threads = 1;
+    int epochs = 500;           // Passes over the whole data set
+    int batchSize = 0;          // Positions per gradient step, 0 uses all of them (plain full batch descent)
+    double learningRate = 1.0;  // Adam step size, in cp
+    double k = 0;               // Sigmoid scale, 0 fits it to the data with the current weights first
+    double lambda = 1.0;        // Target blend: 1 game results only, 0 the stored search scores only
+    bool tuneMaterial = true;   // Piece values too, or just the positional terms
+    int reportEvery = 25;       // Epochs between error reports (and writes of outPath)
+    std::string outPath = "tuned_eval.txt";
+};
+
+struct TunerStats
+{
+    uint64_t positions = 0;
+    double k = 0;
+    double startError = 0;
+    double endError = 0;
+    long long timeMs = 0;
+};
+
+// Texel tuning of EvalWeights over a PackedPosition file (self-play data or epd2bin output): minimizes the mean
+// squared error between sigmoid(eval) and the game result. The eval is linear in the weights, so every position
+// is evaluated once to get its coefficients and the rest runs on those. The tuned weights are written to
+// outPath as a DEFAULT_EVAL_WEIGHTS initializer to paste over the one in core/eval.cpp
+// Returns false if the data couldn't be read
+bool RunTuner(const std::string& dataPath, const TunerOptions& options, TunerStats* stats = nullptr);
@@ -1,5 +1,11 @@
 #include "uci.hpp"
 
+#include "bench.hpp"
+#include "perft.hpp"
+#include "core/cpu.hpp"
+#include "bot/tablebase.hpp"
+#include "core/eval.hpp"
+
 #include <iostream>
 #include <vector>
 #include <string>
@@ -9,19 +15,63 @@
 #include <thread>
 #include <cstdlib>
 #include <ctime>
+#include <algorithm>
+#include <chrono>
+#include <charconv>
 
 Uci::Uci(Engine* engine, Bot* bot)
     : engine(engine), bot(bot)
 {}
 
 void Uci::Loop()
+{
+    // The search runs on this thread and only reads the stop flag, stdin is read on another one
+    std::thread reader(&Uci::ReadInput, this);
+
+    std::string line;
+    while (NextLine(line))
+        HandleCommand(line);
+
+    reader.join();
+}
+
+void Uci::ReadInput()
 {
     std::string line;
     while (std::getline(std::cin, line)) {
         //uciLog << "<<< " << line << std::endl; // log incoming
         //uciLog.flush(); // make sure it writes immediately
-        HandleCommand(line);
+        std::istringstream iss(line);
+        std::string token;
+        iss >> token;
+
+        // Handled here rather than when the line comes up so a running search sees it right away,
+        // go clears it in the same order so a stop sent straight after go isn't lost
+        if (token == "go") stopSearch = false;
+        else if (token == "stop" || token == "quit") stopSearch = true;
+
+        std::lock_guard<std::mutex> lock(inputMutex);
+        input.push_back(line);
+        inputReady.notify_one();
     }
+
+    // No more input, don't leave an infinite search running
+    std::lock_guard<std::mutex> lock(inputMutex);
+    stopSearch = true;
+    inputClosed = true;
+    inputReady.notify_one();
+}
+
+bool Uci::NextLine(std::string& line)
+{
+    std::unique_lock<std::mutex> lock(inputMutex);
+    inputReady.wait(lock, [this] { return !input.empty() || inputClosed; });
+    if (input.empty())
+        return false;
+
+    line = std::move(input.front());
+    input.pop_front();
+    return true;
 }
 
 void Uci::HandleCommand(const std::string& line) 
@@ -32,28 +82,37 @@ void Uci::HandleCommand(const std::string& line)
 
     if (token == "uci")
     {
-        std::cout << "id name ChessEngine" << std::endl;
+        std::cout << "id name ChessEngine " << Cpu::Name(Cpu::Compiled()) << std::endl; // Which build got picked, see Cpu::DispatchToBestFlavor
         std::cout << "id author Joeger" << std::endl;
+        std::cout << "option name Move Overhead type spin default 10 min 0 max 5000" << std::endl;
+        std::cout << "option name Book File type string default res/openings.bin" << std::endl;
+        std::cout << "option name Book Depth type spin default 255 min 0 max 255" << std::endl;
+        std::cout << "option name MultiPV type spin default 1 min 1 max 64" << std::endl;
+        std::cout << "option name SyzygyProbeDepth type spin default 1 min 1 max 100" << std::endl;
+        std::cout << "option name SyzygyProbeLimit type spin default 7 min 0 max 7" << std::endl;
         std::cout << "uciok" << std::endl;
     }
     else if (token == "isready")  std::cout << "readyok" << std::endl;
     else if (token == "position") HandlePosition(iss);
     else if (token == "go")       HandleGo(iss);
+    else if (token == "setoption") HandleSetOption(iss);
+    else if (token == "bench")
+    {
+        std::string arg;
+        iss >> arg;
+        if (arg == "eval")
+        {
+            int runs = 200000;
+            iss >> runs;
+            RunEvalBench(engine, runs);
+        }
+        else
+            RunBench(engine, bot, arg.empty() ? BENCH_DEFAULT_DEPTH : std::atoi(arg.c_str()));
+    }
+    else if (token == "eval") HandleEval();
     else if (token == "ucinewgame")
     {
-        // Should probably clean this up
-        GameState::currentPlayer = Color::WHITE;
-        GameState::checkStatus = 0;
-        GameState::enPassantTarget = 0;
-        GameState::halfmoves = 0;
-        GameState::endgame = false;
-        GameState::checkmate = false;
-        GameState::draw = false;
-        GameState::invalidMove = false;
-        GameState::whiteCastlingRights[0] = true;
-        GameState::whiteCastlingRights[1] = true;
-        GameState::blackCastlingRights[0] = true;
-        GameState::blackCastlingRights[1] = true;
+        GameState::Reset();
 
         delete engine;
         engine = new Engine();
@@ -64,6 +123,20 @@ void Uci::HandleCommand(const std::string& line)
     else if (token == "quit") exit(0);
 }
 
+void Uci::HandleEval()
+{
+    EvalTrace trace;
+    int traced = EvalWithTrace(engine, trace);
+    std::cout << EvalTraceToString(trace);
+
+    // The trace is the reference, the search's Eval() has to match it
+    int eval = Eval(Color::WHITE, engine);
+    if (eval != traced)
+        std::cout << "Eval() mismatch: " << eval << " vs traced " << traced << '\n';
+
+    std::cout << "Eval time " << TimeEval(engine, 100000) << " ns" << std::endl;
+}
+
 void Uci::HandlePosition(std::istringstream& iss)
 {
     std::string line;
@@ -75,7 +148,8 @@ void Uci::HandlePosition(std::istringstream& iss)
 
     if (token == "startpos")
     {
-        engine->LoadPosition("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
+        // Init rather than LoadPosition, the undo list and repetition history need resetting too
+        engine->Init("rnbqkbnr/pppppppp/8/8/8/8/PPPPPPPP/RNBQKBNR w KQkq - 0 1");
         lineSS >> token; // "moves"
     }
     else if (token == "fen")
@@ -88,7 +162,7 @@ void Uci::HandlePosition(std::istringstream& iss)
             fen += fenPart + " ";
         }
 
-        engine->LoadPosition(fen);
+        engine->Init(fen);
         lineSS >> token; // "moves"
     }
 
@@ -123,78 +197,106 @@ void Uci::HandlePosition(std::istringstream& iss)
 //}
 void Uci::HandleGo(std::istringstream& iss)
 {
-    int wtime = -1, btime = -1;        // Remaining time in ms
-    int winc = 0, binc = 0;            // Increment per move in ms
-    int movestogo = -1;                // Moves to next time control
-    int movetime = -1;                 // Fixed time per move
-    int depth = -1, nodes = -1;
-    bool infinite = false;
+    SearchLimits limits;
+    limits.moveOverhead = moveOverhead;
+    limits.multiPV = multiPV;
+    limits.stop = &stopSearch;
 
     std::string token;
     while (iss >> token)
     {
-        if (token == "wtime")      iss >> wtime;
-        else if (token == "btime") iss >> btime;
-        else if (token == "winc")  iss >> winc;
-        else if (token == "binc")  iss >> binc;
-        else if (token == "movestogo") iss >> movestogo;
-        else if (token == "movetime")  iss >> movetime;
-        else if (token == "depth")     iss >> depth;
-        else if (token == "nodes")     iss >> nodes;
-        else if (token == "infinite")  infinite = true;
+        if (token == "perft")
+        {
+            int depth = 1;
+            iss >> depth;
+            PerftTable tt;
+            PerftDivide(engine, depth, &tt);
+            return;
+        }
+        else if (token == "wtime")      iss >> limits.time[0];
+        else if (token == "btime") iss >> limits.time[1];
+        else if (token == "winc")  iss >> limits.inc[0];
+        else if (token == "binc")  iss >> limits.inc[1];
+        else if (token == "movestogo") iss >> limits.movesToGo;
+        else if (token == "movetime")  iss >> limits.moveTime;
+        else if (token == "depth")     iss >> limits.depth;
+        else if (token == "nodes")     iss >> limits.nodes;
+        else if (token == "infinite")  limits.infinite = true;
     }
 
-    // Determine our color
-    Color us = engine->GetCurrentPlayer();
-    int myTime = (us == Color::WHITE ? wtime : btime);
-    int myInc = (us == Color::WHITE ? winc : binc);
-
-    int timeForMove = 0; // ms we allocate to this move
+    // Soft/hard limits are worked out by the bot's time manager
+    bot->SetColor(engine->GetCurrentPlayer());
+    Move bestMove = bot->GetMoveUCI(limits);
 
-    if (movetime > 0)
+    // go infinite doesn't answer before stop, even when the search ends on its own (mate found, max depth)
+    if (limits.infinite)
     {
-        // --- Fixed time per move ---
-        timeForMove = movetime;
+        std::unique_lock<std::mutex> lock(inputMutex);
+        inputReady.wait(lock, [this] { return stopSearch.load(); });
     }
-    else if (infinite)
-    {
-        // --- Search until stop command ---
-        timeForMove = -1; // Let search run indefinitely
-    }
-    else if (myTime > 0)
-    {
-        // --- Regular timed games (sudden death, increment, or moves in X time) ---
 
-        int movesLeft = movestogo > 0 ? movestogo : 40; // Estimate if unknown
+    std::cout << "bestmove " << MoveToUCI(bestMove) << std::endl;
+    std::cout.flush();
+}
+
+// Spin option value clamped to [min, max], false (and out untouched) if it isn't a number
+static bool ParseSpin(const std::string& value, int min, int max, int& out)
+{
+    int parsed = 0;
+    const char* end = value.data() + value.size();
+    auto [ptr, error] = std::from_chars(value.data(), end, parsed);
+    if (error != std::errc() || ptr != end)
+        return false;
+    out = std::max(min, std::min(max, parsed));
+    return true;
+}
 
-        // Base allocation: divide remaining time by moves left
-        timeForMove = myTime / movesLeft;
+void Uci::HandleSetOption(std::istringstream& iss)
+{
+    // setoption name <id> [value <x>], names can have spaces
+    std::string token, name, value;
+    iss >> token; // "name"
 
-        // Add a fraction of increment (dont spend it all)
-        timeForMove += static_cast<int>(0.6 * myInc);
+    while (iss >> token && token != "value")
+        name += (name.empty() ? "" : " ") + token;
+    while (iss >> token)
+        value += (value.empty() ? "" : " ") + token;
 
-        // Safety: dont use more than 1/10 of remaining time on any single move
-        int maxCap = myTime / 10;
-        if (timeForMove > maxCap)
-            timeForMove = maxCap;
+    int spin = 0;
+    auto spinOption = [&](int min, int max)
+    {
+        if (ParseSpin(value, min, max, spin)) return true;
+        std::cout << "info string bad value '" << value << "' for " << name << std::endl;
+        return false;
+    };
 
-        // Never drop below a small minimum
-        if (timeForMove < 10)
-            timeForMove = 10;
+    if (name == "Move Overhead")
+    {
+        if (spinOption(0, 5000)) moveOverhead = spin;
     }
-    else
+    else if (name == "Book File")
     {
-        // No valid timing info (e.g. analysis mode)
-        timeForMove = 1000; // default 1 second
+        // "<empty>" is what some GUIs send for a cleared string option
+        if (value == "<empty>") value.clear();
+        if (!GetOpeningBook().Open(value) && !value.empty())
+            std::cout << "info string could not open book " << value << std::endl;
+    }
+    else if (name == "Book Depth")
+    {
+        if (spinOption(0, 255)) GetOpeningBook().maxPly = spin;
+    }
+    else if (name == "MultiPV")
+    {
+        if (spinOption(1, 64)) multiPV = spin;
+    }
+    else if (name == "SyzygyProbeDepth")
+    {
+        if (spinOption(1, 100)) GetTablebase().probeDepth = spin;
+    }
+    else if (name == "SyzygyProbeLimit")
+    {
+        if (spinOption(0, 7)) GetTablebase().probeLimit = spin;
     }
-
-    int moveOverhead = ((float)timeForMove * 0.05); // Stop 5% early to prevent the engine going barely over on time
-
-    bot->SetColor(us);
-    Move bestMove = bot->GetMoveUCI(timeForMove - moveOverhead);
-
-    std::cout << "bestmove " << MoveToUCI(bestMove) << std::endl;
-    std::cout.flush();
 }
 
 
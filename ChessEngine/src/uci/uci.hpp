@@ -4,6 +4,10 @@
 #include "bot/bot.hpp"
 #include <string>
 #include <sstream>
+#include <deque>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
 
 class Uci
 {
@@ -12,11 +16,26 @@ public:
     void Loop();
 
 private:
+    void ReadInput(); // Runs on its own thread so stop/quit get through while a search is running
+    bool NextLine(std::string& line); // Waits for the next queued line, false once stdin is closed
     void HandleCommand(const std::string& line);
     void HandlePosition(std::istringstream& is);
     void HandleGo(std::istringstream& is);
+    void HandleSetOption(std::istringstream& is);
+    void HandleEval(); // Term by term breakdown of the current position, not part of UCI
     Move ParseMove(const std::string& moveString);
 
     Engine* engine;
     Bot* bot;
+
+    // Lines read by the input thread, handled in order on the search thread (GameState is per thread)
+    std::mutex inputMutex;
+    std::condition_variable inputReady;
+    std::deque<std::string> input;
+    bool inputClosed = false;
+    std::atomic<bool> stopSearch{ false }; // Set by the input thread as soon as it reads stop/quit
+
+    // UCI options
+    int moveOverhead = 10; // ms
+    int multiPV = 1;
 };
\ No newline at end of file